@@ -8,6 +8,7 @@
  * 2012-09-30     Bernard      first version.
  * 2013-05-08     Grissiom     reimplement
  * 2016-08-18     heyuanjie    add interface
+ * 2026-10-18     SLIP         32 bit free running index, power of two size
  */
 
 // #include <rtthread.h>
@@ -15,32 +16,69 @@
 #include "ringbuffer.h"
 #include <string.h>
 
+#define RT_RINGBUFFER_MAX_SIZE  0x80000000UL
+
 rt_inline enum rt_ringbuffer_state rt_ringbuffer_status(struct rt_ringbuffer *rb)
 {
-    if (rb->read_index == rb->write_index)
-    {
-        if (rb->read_mirror == rb->write_mirror)
-            return RT_RINGBUFFER_EMPTY;
-        else
-            return RT_RINGBUFFER_FULL;
-    }
+    rt_size_t size = rt_ringbuffer_data_len(rb);
+
+    if (size == 0)
+        return RT_RINGBUFFER_EMPTY;
+    if (size == rb->buffer_size)
+        return RT_RINGBUFFER_FULL;
     return RT_RINGBUFFER_HALFFULL;
 }
 
+/* copy data into the buffer at index, wrap around with mask */
+rt_inline void rt_ringbuffer_copy_in(struct rt_ringbuffer *rb,
+                                     rt_uint32_t           index,
+                                     const rt_uint8_t     *ptr,
+                                     rt_size_t             length)
+{
+    rt_uint32_t offset = index & (rb->buffer_size - 1);
+    rt_size_t first = rb->buffer_size - offset;
+
+    if (first > length)
+        first = length;
+    memcpy(&rb->buffer_ptr[offset], ptr, first);
+    memcpy(&rb->buffer_ptr[0], &ptr[first], length - first);
+}
+
+/* copy data out of the buffer at index, wrap around with mask */
+rt_inline void rt_ringbuffer_copy_out(struct rt_ringbuffer *rb,
+                                      rt_uint32_t           index,
+                                      rt_uint8_t           *ptr,
+                                      rt_size_t             length)
+{
+    rt_uint32_t offset = index & (rb->buffer_size - 1);
+    rt_size_t first = rb->buffer_size - offset;
+
+    if (first > length)
+        first = length;
+    memcpy(ptr, &rb->buffer_ptr[offset], first);
+    memcpy(&ptr[first], &rb->buffer_ptr[0], length - first);
+}
+
 void rt_ringbuffer_init(struct rt_ringbuffer *rb,
                         rt_uint8_t           *pool,
-                        rt_int16_t            size)
+                        rt_uint32_t           size)
 {
     RT_ASSERT(rb != RT_NULL);
     RT_ASSERT(size > 0);
 
     /* initialize read and write index */
-    rb->read_mirror = rb->read_index = 0;
-    rb->write_mirror = rb->write_index = 0;
+    rb->read_index = 0;
+    rb->write_index = 0;
+
+    /* round the size down to a power of two */
+    if (size > RT_RINGBUFFER_MAX_SIZE)
+        size = RT_RINGBUFFER_MAX_SIZE;
+    while (size & (size - 1))
+        size &= size - 1;
 
     /* set buffer pool and size */
     rb->buffer_ptr = pool;
-    rb->buffer_size = RT_ALIGN_DOWN(size, RT_ALIGN_SIZE);
+    rb->buffer_size = size;
 }
 //RTM_EXPORT(rt_ringbuffer_init);
 
@@ -49,43 +87,21 @@ void rt_ringbuffer_init(struct rt_ringbuffer *rb,
  */
 rt_size_t rt_ringbuffer_put(struct rt_ringbuffer *rb,
                             const rt_uint8_t     *ptr,
-                            rt_uint16_t           length)
+                            rt_size_t             length)
 {
-    rt_uint16_t size;
+    rt_size_t size;
 
     RT_ASSERT(rb != RT_NULL);
 
     /* whether has enough space */
     size = rt_ringbuffer_space_len(rb);
 
-    /* no space */
-    if (size == 0)
-        return 0;
-
     /* drop some data */
     if (size < length)
         length = size;
 
-    if (rb->buffer_size - rb->write_index > length)
-    {
-        /* read_index - write_index = empty space */
-        memcpy(&rb->buffer_ptr[rb->write_index], ptr, length);
-        /* this should not cause overflow because there is enough space for
-         * length of data in current mirror */
-        rb->write_index += length;
-        return length;
-    }
-
-    memcpy(&rb->buffer_ptr[rb->write_index],
-           &ptr[0],
-           rb->buffer_size - rb->write_index);
-    memcpy(&rb->buffer_ptr[0],
-           &ptr[rb->buffer_size - rb->write_index],
-           length - (rb->buffer_size - rb->write_index));
-
-    /* we are going into the other side of the mirror */
-    rb->write_mirror = ~rb->write_mirror;
-    rb->write_index = length - (rb->buffer_size - rb->write_index);
+    rt_ringbuffer_copy_in(rb, rb->write_index, ptr, length);
+    rb->write_index += length;
 
     return length;
 }
@@ -98,9 +114,9 @@ rt_size_t rt_ringbuffer_put(struct rt_ringbuffer *rb,
  */
 rt_size_t rt_ringbuffer_put_force(struct rt_ringbuffer *rb,
                             const rt_uint8_t     *ptr,
-                            rt_uint16_t           length)
+                            rt_size_t             length)
 {
-    rt_uint16_t space_length;
+    rt_size_t space_length;
 
     RT_ASSERT(rb != RT_NULL);
 
@@ -112,36 +128,12 @@ rt_size_t rt_ringbuffer_put_force(struct rt_ringbuffer *rb,
         length = rb->buffer_size;
     }
 
-    if (rb->buffer_size - rb->write_index > length)
-    {
-        /* read_index - write_index = empty space */
-        memcpy(&rb->buffer_ptr[rb->write_index], ptr, length);
-        /* this should not cause overflow because there is enough space for
-         * length of data in current mirror */
-        rb->write_index += length;
-
-        if (length > space_length)
-            rb->read_index = rb->write_index;
-
-        return length;
-    }
-
-    memcpy(&rb->buffer_ptr[rb->write_index],
-           &ptr[0],
-           rb->buffer_size - rb->write_index);
-    memcpy(&rb->buffer_ptr[0],
-           &ptr[rb->buffer_size - rb->write_index],
-           length - (rb->buffer_size - rb->write_index));
-
-    /* we are going into the other side of the mirror */
-    rb->write_mirror = ~rb->write_mirror;
-    rb->write_index = length - (rb->buffer_size - rb->write_index);
+    rt_ringbuffer_copy_in(rb, rb->write_index, ptr, length);
+    rb->write_index += length;
 
+    /* the oldest data is overwritten */
     if (length > space_length)
-    {
-        rb->read_mirror = ~rb->read_mirror;
-        rb->read_index = rb->write_index;
-    }
+        rb->read_index = rb->write_index - rb->buffer_size;
 
     return length;
 }
@@ -152,7 +144,7 @@ rt_size_t rt_ringbuffer_put_force(struct rt_ringbuffer *rb,
  */
 rt_size_t rt_ringbuffer_get(struct rt_ringbuffer *rb,
                             rt_uint8_t           *ptr,
-                            rt_uint16_t           length)
+                            rt_size_t             length)
 {
     rt_size_t size;
 
@@ -161,34 +153,12 @@ rt_size_t rt_ringbuffer_get(struct rt_ringbuffer *rb,
     /* whether has enough data  */
     size = rt_ringbuffer_data_len(rb);
 
-    /* no data */
-    if (size == 0)
-        return 0;
-
     /* less data */
     if (size < length)
         length = size;
 
-    if (rb->buffer_size - rb->read_index > length)
-    {
-        /* copy all of data */
-        memcpy(ptr, &rb->buffer_ptr[rb->read_index], length);
-        /* this should not cause overflow because there is enough space for
-         * length of data in current mirror */
-        rb->read_index += length;
-        return length;
-    }
-
-    memcpy(&ptr[0],
-           &rb->buffer_ptr[rb->read_index],
-           rb->buffer_size - rb->read_index);
-    memcpy(&ptr[rb->buffer_size - rb->read_index],
-           &rb->buffer_ptr[0],
-           length - (rb->buffer_size - rb->read_index));
-
-    /* we are going into the other side of the mirror */
-    rb->read_mirror = ~rb->read_mirror;
-    rb->read_index = length - (rb->buffer_size - rb->read_index);
+    rt_ringbuffer_copy_out(rb, rb->read_index, ptr, length);
+    rb->read_index += length;
 
     return length;
 }
@@ -199,6 +169,8 @@ rt_size_t rt_ringbuffer_get(struct rt_ringbuffer *rb,
  */
 rt_size_t rt_ringbuffer_peak(struct rt_ringbuffer *rb, rt_uint8_t **ptr)
 {
+    rt_uint32_t offset;
+
     RT_ASSERT(rb != RT_NULL);
 
     *ptr = RT_NULL;
@@ -210,23 +182,120 @@ rt_size_t rt_ringbuffer_peak(struct rt_ringbuffer *rb, rt_uint8_t **ptr)
     if (size == 0)
         return 0;
 
-    *ptr = &rb->buffer_ptr[rb->read_index];
+    offset = rb->read_index & (rb->buffer_size - 1);
+    *ptr = &rb->buffer_ptr[offset];
 
-    if(rb->buffer_size - rb->read_index > size)
-    {
-        rb->read_index += size;
-        return size;
-    }
+    /* only the contiguous part */
+    if (size > rb->buffer_size - offset)
+        size = rb->buffer_size - offset;
+    rb->read_index += size;
 
-    size = rb->buffer_size - rb->read_index;
+    return size;
+}
+//RTM_EXPORT(rt_ringbuffer_peak);
 
-    /* we are going into the other side of the mirror */
-    rb->read_mirror = ~rb->read_mirror;
-    rb->read_index = 0;
+/**
+ * peek data in ring buffer without moving the read index
+ *
+ * The data is returned as up to two contiguous spans, the second one is
+ * used when the data wraps around. Call rt_ringbuffer_consume() after the
+ * data has been processed.
+ */
+rt_size_t rt_ringbuffer_peek_span(struct rt_ringbuffer *rb,
+                                  rt_uint8_t           *ptr[2],
+                                  rt_size_t             length[2])
+{
+    rt_size_t size;
+    rt_uint32_t offset;
+
+    RT_ASSERT(rb != RT_NULL);
+
+    size = rt_ringbuffer_data_len(rb);
+    offset = rb->read_index & (rb->buffer_size - 1);
+
+    ptr[0] = &rb->buffer_ptr[offset];
+    ptr[1] = &rb->buffer_ptr[0];
+
+    length[0] = rb->buffer_size - offset;
+    if (length[0] > size)
+        length[0] = size;
+    length[1] = size - length[0];
 
     return size;
 }
-//RTM_EXPORT(rt_ringbuffer_peak);
+//RTM_EXPORT(rt_ringbuffer_peek_span);
+
+/**
+ * consume data in ring buffer, used with rt_ringbuffer_peek_span()
+ */
+rt_size_t rt_ringbuffer_consume(struct rt_ringbuffer *rb, rt_size_t length)
+{
+    rt_size_t size;
+
+    RT_ASSERT(rb != RT_NULL);
+
+    size = rt_ringbuffer_data_len(rb);
+
+    /* less data */
+    if (size < length)
+        length = size;
+
+    rb->read_index += length;
+
+    return length;
+}
+//RTM_EXPORT(rt_ringbuffer_consume);
+
+/**
+ * get empty space in ring buffer to write data in place
+ *
+ * The space is returned as up to two contiguous spans, write data to them
+ * and call rt_ringbuffer_commit() to put it into the ring buffer.
+ */
+rt_size_t rt_ringbuffer_reserve_span(struct rt_ringbuffer *rb,
+                                     rt_uint8_t           *ptr[2],
+                                     rt_size_t             length[2])
+{
+    rt_size_t size;
+    rt_uint32_t offset;
+
+    RT_ASSERT(rb != RT_NULL);
+
+    size = rt_ringbuffer_space_len(rb);
+    offset = rb->write_index & (rb->buffer_size - 1);
+
+    ptr[0] = &rb->buffer_ptr[offset];
+    ptr[1] = &rb->buffer_ptr[0];
+
+    length[0] = rb->buffer_size - offset;
+    if (length[0] > size)
+        length[0] = size;
+    length[1] = size - length[0];
+
+    return size;
+}
+//RTM_EXPORT(rt_ringbuffer_reserve_span);
+
+/**
+ * commit data written to the spans of rt_ringbuffer_reserve_span()
+ */
+rt_size_t rt_ringbuffer_commit(struct rt_ringbuffer *rb, rt_size_t length)
+{
+    rt_size_t size;
+
+    RT_ASSERT(rb != RT_NULL);
+
+    size = rt_ringbuffer_space_len(rb);
+
+    /* no more space */
+    if (size < length)
+        length = size;
+
+    rb->write_index += length;
+
+    return length;
+}
+//RTM_EXPORT(rt_ringbuffer_commit);
 
 /**
  * put a character into ring buffer
@@ -239,18 +308,8 @@ rt_size_t rt_ringbuffer_putchar(struct rt_ringbuffer *rb, const rt_uint8_t ch)
     if (!rt_ringbuffer_space_len(rb))
         return 0;
 
-    rb->buffer_ptr[rb->write_index] = ch;
-
-    /* flip mirror */
-    if (rb->write_index == rb->buffer_size-1)
-    {
-        rb->write_mirror = ~rb->write_mirror;
-        rb->write_index = 0;
-    }
-    else
-    {
-        rb->write_index++;
-    }
+    rb->buffer_ptr[rb->write_index & (rb->buffer_size - 1)] = ch;
+    rb->write_index++;
 
     return 1;
 }
@@ -269,25 +328,11 @@ rt_size_t rt_ringbuffer_putchar_force(struct rt_ringbuffer *rb, const rt_uint8_t
 
     old_state = rt_ringbuffer_status(rb);
 
-    rb->buffer_ptr[rb->write_index] = ch;
+    rb->buffer_ptr[rb->write_index & (rb->buffer_size - 1)] = ch;
+    rb->write_index++;
 
-    /* flip mirror */
-    if (rb->write_index == rb->buffer_size-1)
-    {
-        rb->write_mirror = ~rb->write_mirror;
-        rb->write_index = 0;
-        if (old_state == RT_RINGBUFFER_FULL)
-        {
-            rb->read_mirror = ~rb->read_mirror;
-            rb->read_index = rb->write_index;
-        }
-    }
-    else
-    {
-        rb->write_index++;
-        if (old_state == RT_RINGBUFFER_FULL)
-            rb->read_index = rb->write_index;
-    }
+    if (old_state == RT_RINGBUFFER_FULL)
+        rb->read_index++;
 
     return 1;
 }
@@ -305,43 +350,13 @@ rt_size_t rt_ringbuffer_getchar(struct rt_ringbuffer *rb, rt_uint8_t *ch)
         return 0;
 
     /* put character */
-    *ch = rb->buffer_ptr[rb->read_index];
-
-    if (rb->read_index == rb->buffer_size-1)
-    {
-        rb->read_mirror = ~rb->read_mirror;
-        rb->read_index = 0;
-    }
-    else
-    {
-        rb->read_index++;
-    }
+    *ch = rb->buffer_ptr[rb->read_index & (rb->buffer_size - 1)];
+    rb->read_index++;
 
     return 1;
 }
 //RTM_EXPORT(rt_ringbuffer_getchar);
 
-/**
- * get the size of data in rb
- */
-rt_size_t rt_ringbuffer_data_len(struct rt_ringbuffer *rb)
-{
-    switch (rt_ringbuffer_status(rb))
-    {
-    case RT_RINGBUFFER_EMPTY:
-        return 0;
-    case RT_RINGBUFFER_FULL:
-        return rb->buffer_size;
-    case RT_RINGBUFFER_HALFFULL:
-    default:
-        if (rb->write_index > rb->read_index)
-            return rb->write_index - rb->read_index;
-        else
-            return rb->buffer_size - (rb->read_index - rb->write_index);
-    };
-}
-//RTM_EXPORT(rt_ringbuffer_data_len);
-
 /**
  * empty the rb
  */
@@ -349,23 +364,24 @@ void rt_ringbuffer_reset(struct rt_ringbuffer *rb)
 {
     RT_ASSERT(rb != RT_NULL);
 
-    rb->read_mirror = 0;
     rb->read_index = 0;
-    rb->write_mirror = 0;
     rb->write_index = 0;
 }
 //RTM_EXPORT(rt_ringbuffer_reset);
 
 #ifdef RT_USING_HEAP
 
-struct rt_ringbuffer* rt_ringbuffer_create(rt_uint16_t size)
+struct rt_ringbuffer* rt_ringbuffer_create(rt_uint32_t size)
 {
     struct rt_ringbuffer *rb;
     rt_uint8_t *pool;
 
     RT_ASSERT(size > 0);
 
-    size = RT_ALIGN_DOWN(size, RT_ALIGN_SIZE);
+    if (size > RT_RINGBUFFER_MAX_SIZE)
+        size = RT_RINGBUFFER_MAX_SIZE;
+    while (size & (size - 1))
+        size &= size - 1;
 
     rb = (struct rt_ringbuffer *)rt_malloc(sizeof(struct rt_ringbuffer));
     if (rb == RT_NULL)
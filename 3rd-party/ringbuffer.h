@@ -19,6 +19,7 @@ extern "C" {
 
 typedef uint8_t  rt_uint8_t;
 typedef uint16_t rt_uint16_t;
+typedef uint32_t rt_uint32_t;
 typedef int16_t  rt_int16_t;
 typedef size_t  rt_size_t;
 #define rt_inline static inline
@@ -38,35 +39,24 @@ typedef size_t  rt_size_t;
 struct rt_ringbuffer
 {
     rt_uint8_t *buffer_ptr;
-    /* use the msb of the {read,write}_index as mirror bit. You can see this as
-     * if the buffer adds a virtual mirror and the pointers point either to the
-     * normal or to the mirrored buffer. If the write_index has the same value
-     * with the read_index, but in a different mirror, the buffer is full.
-     * While if the write_index and the read_index are the same and within the
-     * same mirror, the buffer is empty. The ASCII art of the ringbuffer is:
+    /* {read,write}_index are free running 32 bit counters, they are only
+     * masked with (buffer_size - 1) when the buffer is accessed. The buffer
+     * size is a power of two, so the data length is always
+     * write_index - read_index, even after the counters wrap around:
      *
-     *          mirror = 0                    mirror = 1
-     * +---+---+---+---+---+---+---+|+~~~+~~~+~~~+~~~+~~~+~~~+~~~+
-     * | 0 | 1 | 2 | 3 | 4 | 5 | 6 ||| 0 | 1 | 2 | 3 | 4 | 5 | 6 | Full
-     * +---+---+---+---+---+---+---+|+~~~+~~~+~~~+~~~+~~~+~~~+~~~+
-     *  read_idx-^                   write_idx-^
+     * +---+---+---+---+---+---+---+---+
+     * | 0 | 1 | 2 | 3 | 4 | 5 | 6 | 7 |   write_index - read_index == 0: Empty
+     * +---+---+---+---+---+---+---+---+   write_index - read_index == 8: Full
+     *   read_idx & 7-^       ^-write_idx & 7
      *
-     * +---+---+---+---+---+---+---+|+~~~+~~~+~~~+~~~+~~~+~~~+~~~+
-     * | 0 | 1 | 2 | 3 | 4 | 5 | 6 ||| 0 | 1 | 2 | 3 | 4 | 5 | 6 | Empty
-     * +---+---+---+---+---+---+---+|+~~~+~~~+~~~+~~~+~~~+~~~+~~~+
-     * read_idx-^ ^-write_idx
+     * There is no mirror bit and no branch to wrap an index, and the buffer
+     * could be as large as 2GiB.
      *
-     * The tradeoff is we could only use 32KiB of buffer for 16 bit of index.
-     * But it should be enough for most of the cases.
-     *
-     * Ref: http://en.wikipedia.org/wiki/Circular_buffer#Mirroring */
-    rt_uint16_t read_mirror : 1;
-    rt_uint16_t read_index : 15;
-    rt_uint16_t write_mirror : 1;
-    rt_uint16_t write_index : 15;
-    /* as we use msb of index as mirror bit, the size should be signed and
-     * could only be positive. */
-    rt_int16_t buffer_size;
+     * Ref: http://en.wikipedia.org/wiki/Circular_buffer */
+    rt_uint32_t read_index;
+    rt_uint32_t write_index;
+    /* power of two */
+    rt_uint32_t buffer_size;
 };
 
 enum rt_ringbuffer_state
@@ -83,28 +73,37 @@ enum rt_ringbuffer_state
  * Please note that the ring buffer implementation of RT-Thread
  * has no thread wait or resume feature.
  */
-void rt_ringbuffer_init(struct rt_ringbuffer *rb, rt_uint8_t *pool, rt_int16_t size);
+void rt_ringbuffer_init(struct rt_ringbuffer *rb, rt_uint8_t *pool, rt_uint32_t size);
 void rt_ringbuffer_reset(struct rt_ringbuffer *rb);
-rt_size_t rt_ringbuffer_put(struct rt_ringbuffer *rb, const rt_uint8_t *ptr, rt_uint16_t length);
-rt_size_t rt_ringbuffer_put_force(struct rt_ringbuffer *rb, const rt_uint8_t *ptr, rt_uint16_t length);
+rt_size_t rt_ringbuffer_put(struct rt_ringbuffer *rb, const rt_uint8_t *ptr, rt_size_t length);
+rt_size_t rt_ringbuffer_put_force(struct rt_ringbuffer *rb, const rt_uint8_t *ptr, rt_size_t length);
 rt_size_t rt_ringbuffer_putchar(struct rt_ringbuffer *rb, const rt_uint8_t ch);
 rt_size_t rt_ringbuffer_putchar_force(struct rt_ringbuffer *rb, const rt_uint8_t ch);
-rt_size_t rt_ringbuffer_get(struct rt_ringbuffer *rb, rt_uint8_t *ptr, rt_uint16_t length);
+rt_size_t rt_ringbuffer_get(struct rt_ringbuffer *rb, rt_uint8_t *ptr, rt_size_t length);
 rt_size_t rt_ringbuffer_peak(struct rt_ringbuffer *rb, rt_uint8_t **ptr);
 rt_size_t rt_ringbuffer_getchar(struct rt_ringbuffer *rb, rt_uint8_t *ch);
-rt_size_t rt_ringbuffer_data_len(struct rt_ringbuffer *rb);
+rt_size_t rt_ringbuffer_peek_span(struct rt_ringbuffer *rb, rt_uint8_t *ptr[2], rt_size_t length[2]);
+rt_size_t rt_ringbuffer_consume(struct rt_ringbuffer *rb, rt_size_t length);
+rt_size_t rt_ringbuffer_reserve_span(struct rt_ringbuffer *rb, rt_uint8_t *ptr[2], rt_size_t length[2]);
+rt_size_t rt_ringbuffer_commit(struct rt_ringbuffer *rb, rt_size_t length);
 
 #ifdef RT_USING_HEAP
-struct rt_ringbuffer* rt_ringbuffer_create(rt_uint16_t length);
+struct rt_ringbuffer* rt_ringbuffer_create(rt_uint32_t length);
 void rt_ringbuffer_destroy(struct rt_ringbuffer *rb);
 #endif
 
-rt_inline rt_uint16_t rt_ringbuffer_get_size(struct rt_ringbuffer *rb)
+rt_inline rt_uint32_t rt_ringbuffer_get_size(struct rt_ringbuffer *rb)
 {
     RT_ASSERT(rb != RT_NULL);
     return rb->buffer_size;
 }
 
+/** return the size of data in rb */
+rt_inline rt_size_t rt_ringbuffer_data_len(struct rt_ringbuffer *rb)
+{
+    return (rt_uint32_t)(rb->write_index - rb->read_index);
+}
+
 /** return the size of empty space in rb */
 #define rt_ringbuffer_space_len(rb) ((rb)->buffer_size - rt_ringbuffer_data_len(rb))
 
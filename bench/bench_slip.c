@@ -0,0 +1,433 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "slip.h"
+#include "slip_scan.h"
+#include "slip_parallel.h"
+
+#define BENCH_DATA_SIZE     (64 * 1024)
+#define BENCH_ROUNDS        2000
+#define BENCH_FRAME_SIZE    1000
+#define BENCH_MTU           1500
+#define BENCH_FRAME_BYTES   (4 * 1024 * 1024)
+#define BENCH_MAX_FRAMES    (BENCH_FRAME_BYTES / 16)
+#define BENCH_CAPTURE_SIZE  (64 * 1024 * 1024)
+#define BENCH_CAPTURE_ROUNDS 5
+
+static uint8_t src[BENCH_DATA_SIZE];
+static uint8_t dst[BENCH_DATA_SIZE * 2];
+static size_t stream_length;
+static uint8_t stream[BENCH_DATA_SIZE * 3];
+static uint8_t frame[BENCH_FRAME_SIZE];
+static int csv;
+
+/* Loopback link of the frame benchmark, holds one encoded frame. */
+struct bench_link {
+    uint8_t data[2 * BENCH_MTU + 2];
+    size_t length;
+    size_t read;
+};
+static uint8_t payload[BENCH_MTU];
+static uint8_t received[BENCH_MTU];
+static double send_ns[BENCH_MAX_FRAMES];
+static double recv_ns[BENCH_MAX_FRAMES];
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/* Print a result row, fields not measured are negative. */
+static void report(const char *bench, const char *pattern, size_t size, const char *impl,
+                   double mbps, double fps, double p50, double p99, double speedup)
+{
+    const double values[] = { mbps, fps, p50, p99, speedup };
+    static const char *const text_format[] = { " %10.1f", " %12.0f", " %9.0f", " %9.0f", " %7.2fx" };
+    static const int text_width[] = { 11, 13, 10, 10, 9 };
+
+    if (csv)
+        printf("%s,%s,%zu,%s", bench, pattern, size, impl);
+    else
+        printf("%-8s %-8s %6zu %-10s", bench, pattern, size, impl);
+    for (size_t i = 0; i < ARRAY_SIZE(values); i++) {
+        if (csv)
+            values[i] < 0 ? printf(",") : printf(",%.2f", values[i]);
+        else
+            values[i] < 0 ? printf("%*s", text_width[i], "-") : printf(text_format[i], values[i]);
+    }
+    printf("\n");
+}
+
+static int compare_double(const void *a, const void *b)
+{
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+/* Percentile of sorted samples. */
+static double percentile(const double *samples, size_t count, unsigned p)
+{
+    return samples[(count - 1) * p / 100];
+}
+
+/* Fill data, `percent` of the bytes are SLIP_END or SLIP_ESC. */
+static void fill(unsigned percent)
+{
+    srand(1);
+    for (size_t i = 0; i < ARRAY_SIZE(src); i++) {
+        if ((unsigned)(rand() % 100) < percent) {
+            src[i] = (rand() & 1) ? SLIP_END : SLIP_ESC;
+        } else {
+            do {
+                src[i] = (uint8_t)rand();
+            } while (src[i] == SLIP_END || src[i] == SLIP_ESC);
+        }
+    }
+}
+
+/* Byte by byte encoder, the way slip_send_frame() used to work. */
+static size_t encode_bytewise(uint8_t *out, const uint8_t *in, size_t length)
+{
+    size_t idx = 0;
+    for (size_t i = 0; i < length; i++) {
+        uint8_t c = in[i];
+        switch (c) {
+        case SLIP_END:
+            out[idx++] = SLIP_ESC;
+            c = SLIP_ESC_END;
+            break;
+        case SLIP_ESC:
+            out[idx++] = SLIP_ESC;
+            c = SLIP_ESC_ESC;
+            break;
+        default:    break;
+        }
+        out[idx++] = c;
+    }
+    return idx;
+}
+
+static double bench_bytewise(void)
+{
+    volatile size_t sink = 0;
+    double start = now();
+    for (int r = 0; r < BENCH_ROUNDS; r++)
+        sink += encode_bytewise(dst, src, ARRAY_SIZE(src));
+    (void)sink;
+    return now() - start;
+}
+
+static double bench_encode(void)
+{
+    volatile size_t sink = 0;
+    size_t used;
+    double start = now();
+    for (int r = 0; r < BENCH_ROUNDS; r++)
+        sink += slip_encode(dst, ARRAY_SIZE(dst), src, ARRAY_SIZE(src), &used);
+    (void)sink;
+    return now() - start;
+}
+
+/* Encode `src` to a stream of BENCH_FRAME_SIZE frames. */
+static void fill_stream(void)
+{
+    size_t used;
+
+    stream_length = 0;
+    for (size_t i = 0; i < ARRAY_SIZE(src); i += BENCH_FRAME_SIZE) {
+        size_t length = ARRAY_SIZE(src) - i;
+        if (length > BENCH_FRAME_SIZE)
+            length = BENCH_FRAME_SIZE;
+        stream[stream_length++] = SLIP_END;
+        stream_length += slip_encode(&stream[stream_length], ARRAY_SIZE(stream) - stream_length,
+                                     &src[i], length, &used);
+        stream[stream_length++] = SLIP_END;
+    }
+}
+
+/* Byte by byte decoder, the way slip_receive_frame() used to work. */
+static size_t decode_bytewise(const uint8_t *in, size_t length)
+{
+    SLIP_DECODER_STATE state = SLIP_UNKNOWN_STATE;
+    size_t idx = 0, frames = 0;
+    for (size_t i = 0; i < length; i++) {
+        uint8_t ch = in[i];
+        switch (state) {
+        case SLIP_UNKNOWN_STATE:
+            if (ch == SLIP_END)
+                state = SLIP_FRAME_START_STATE;
+            break;
+        case SLIP_FRAME_START_STATE:
+            if (ch == SLIP_END)
+                break;
+            state = SLIP_DECODING_STATE;
+            // fall through
+        case SLIP_DECODING_STATE:
+            if (ch == SLIP_ESC) {
+                ch = in[++i];
+                frame[idx++] = (ch == SLIP_ESC_END) ? SLIP_END : SLIP_ESC;
+            } else if (ch == SLIP_END) {
+                state = SLIP_FRAME_END_STATE;
+                frames++;
+                idx = 0;
+            } else {
+                frame[idx++] = ch;
+            }
+            break;
+        case SLIP_FRAME_END_STATE:
+            state = (ch == SLIP_END) ? SLIP_DECODING_STATE : SLIP_ERROR_STATE;
+            break;
+        case SLIP_ERROR_STATE:
+            if (ch == SLIP_END)
+                state = SLIP_FRAME_END_STATE;
+            break;
+        default:    break;
+        }
+    }
+    return frames;
+}
+
+static double bench_decode_bytewise(void)
+{
+    volatile size_t sink = 0;
+    double start = now();
+    for (int r = 0; r < BENCH_ROUNDS; r++)
+        sink += decode_bytewise(stream, stream_length);
+    (void)sink;
+    return now() - start;
+}
+
+static double bench_decode(void)
+{
+    volatile size_t sink = 0;
+    struct slip_decoder decoder;
+    double start = now();
+    for (int r = 0; r < BENCH_ROUNDS; r++) {
+        const uint8_t *data = stream;
+        size_t length = stream_length, consumed;
+
+        slip_decoder_init(&decoder, frame, ARRAY_SIZE(frame));
+        while (length > 0) {
+            sink += slip_decoder_feed(&decoder, data, length, &consumed);
+            data += consumed;
+            length -= consumed;
+        }
+    }
+    (void)sink;
+    return now() - start;
+}
+
+static void bench_link_send(void *user, uint8_t *buffer, uint16_t length)
+{
+    struct bench_link *link = user;
+    memcpy(&link->data[link->length], buffer, length);
+    link->length += length;
+}
+
+static int bench_link_recv(void *user, uint8_t *buffer, uint16_t length)
+{
+    struct bench_link *link = user;
+    size_t size = link->length - link->read;
+    if (size > length)
+        size = length;
+    memcpy(buffer, &link->data[link->read], size);
+    link->read += size;
+    return size;
+}
+
+/* Fill frame payload: "none" has no special bytes, "random" is uniform, "all-c0" is all SLIP_END. */
+static void fill_payload(const char *pattern)
+{
+    srand(1);
+    for (size_t i = 0; i < ARRAY_SIZE(payload); i++) {
+        if (strcmp(pattern, "all-c0") == 0) {
+            payload[i] = SLIP_END;
+        } else {
+            do {
+                payload[i] = (uint8_t)rand();
+            } while (strcmp(pattern, "none") == 0 && (payload[i] == SLIP_END || payload[i] == SLIP_ESC));
+        }
+    }
+}
+
+/* Send and receive `size` bytes frames over a loopback link, timing each call. */
+static void bench_frames(const char *pattern, size_t size)
+{
+    static struct bench_link link;
+    static uint8_t rx_pool[4096];
+    static uint8_t tx_buffer[2 * BENCH_MTU + 2];
+    struct slip_config config = {
+        .send = bench_link_send,
+        .recv = bench_link_recv,
+        .user = &link,
+    };
+    struct slip handler;
+    size_t frames = BENCH_FRAME_BYTES / size;
+    double send_total = 0, recv_total = 0;
+    uint16_t length;
+
+    if (frames > BENCH_MAX_FRAMES)
+        frames = BENCH_MAX_FRAMES;
+    slip_init_with_buffer(&handler, &config, rx_pool, ARRAY_SIZE(rx_pool), tx_buffer, ARRAY_SIZE(tx_buffer));
+    for (size_t i = 0; i < frames; i++) {
+        link.length = link.read = 0;
+
+        double start = now();
+        slip_send_frame(&handler, payload, size);
+        double middle = now();
+        slip_receive_frame(&handler, received, ARRAY_SIZE(received), &length);
+        double end = now();
+
+        if (length != size) {
+            fprintf(stderr, "frame %zu of %s/%zu: received %u bytes\n", i, pattern, size, length);
+            exit(1);
+        }
+        send_ns[i] = (middle - start) * 1e9;
+        recv_ns[i] = (end - middle) * 1e9;
+        send_total += middle - start;
+        recv_total += end - middle;
+    }
+
+    qsort(send_ns, frames, sizeof(send_ns[0]), compare_double);
+    qsort(recv_ns, frames, sizeof(recv_ns[0]), compare_double);
+    double mbytes = (double)size * frames / 1e6;
+    report("send", pattern, size, "auto", mbytes / send_total, frames / send_total,
+           percentile(send_ns, frames, 50), percentile(send_ns, frames, 99), -1);
+    report("receive", pattern, size, "auto", mbytes / recv_total, frames / recv_total,
+           percentile(recv_ns, frames, 50), percentile(recv_ns, frames, 99), -1);
+}
+
+/* slip_decode_parallel() over a capture of `stream` copies, best of a few rounds per thread count. */
+static void bench_parallel(const char *pattern)
+{
+    size_t copies = BENCH_CAPTURE_SIZE / stream_length, length = copies * stream_length;
+    size_t frames = copies * ((BENCH_DATA_SIZE + BENCH_FRAME_SIZE - 1) / BENCH_FRAME_SIZE);
+    uint8_t *capture = malloc(length), *out = malloc(length);
+    struct slip_frame *decoded = malloc(frames * sizeof(*decoded));
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    double mbytes = (double)copies * BENCH_DATA_SIZE / 1e6, base = 0;
+    char impl[32];
+
+    if (capture == NULL || out == NULL || decoded == NULL) {
+        fprintf(stderr, "parallel: out of memory\n");
+        exit(1);
+    }
+    for (size_t i = 0; i < copies; i++)
+        memcpy(&capture[i * stream_length], stream, stream_length);
+
+    if (cpus < 1)
+        cpus = 1;
+    for (long threads = 1; ; threads *= 2) {
+        double best = 0;
+        if (threads > cpus)
+            threads = cpus;
+        for (int r = 0; r < BENCH_CAPTURE_ROUNDS; r++) {
+            size_t consumed;
+            double start = now();
+            long count = slip_decode_parallel(capture, length, out, decoded, frames, &consumed, (int)threads);
+            double t = now() - start;
+            if (count != (long)frames) {
+                fprintf(stderr, "parallel: %ld of %zu frames\n", count, frames);
+                exit(1);
+            }
+            if (r == 0 || t < best)
+                best = t;
+        }
+        if (threads == 1)
+            base = best;
+        snprintf(impl, sizeof(impl), "%ld thread", threads);
+        report("parallel", pattern, BENCH_FRAME_SIZE, impl, mbytes / best, frames / best, -1, -1, base / best);
+        if (threads == cpus)
+            break;
+    }
+    free(capture);
+    free(out);
+    free(decoded);
+}
+
+int main(int argc, char *argv[])
+{
+    static const unsigned densities[] = { 0, 1, 50 };
+    static const struct {
+        const char *name;
+        SLIP_SCAN_IMPL impl;
+    } impls[] = {
+        { "scalar", SLIP_SCAN_SCALAR },
+        { "sse2",   SLIP_SCAN_SSE2 },
+        { "avx2",   SLIP_SCAN_AVX2 },
+    };
+    static const char *const patterns[] = { "none", "random", "all-c0" };
+    static const size_t sizes[] = { 16, 64, 256, 1024, BENCH_MTU };
+    const double mbytes = (double)BENCH_DATA_SIZE * BENCH_ROUNDS / 1e6;
+    char pattern[8];
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--csv") == 0) {
+            csv = 1;
+        } else {
+            fprintf(stderr, "usage: %s [--csv]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    if (csv)
+        printf("bench,pattern,size,impl,mb_per_s,frames_per_s,p50_ns,p99_ns,speedup\n");
+    else
+        printf("%-8s %-8s %6s %-10s %10s %12s %9s %9s %8s\n",
+               "bench", "pattern", "size", "impl", "MB/s", "frames/s", "p50(ns)", "p99(ns)", "speedup");
+
+    // slip_encode() over a large buffer, `pattern` is the escape density.
+    for (size_t d = 0; d < ARRAY_SIZE(densities); d++) {
+        fill(densities[d]);
+        snprintf(pattern, sizeof(pattern), "%u%%", densities[d]);
+
+        double base = bench_bytewise();
+        report("encode", pattern, BENCH_DATA_SIZE, "bytewise", mbytes / base, -1, -1, -1, 1.0);
+        for (size_t i = 0; i < ARRAY_SIZE(impls); i++) {
+            if (slip_scan_select(impls[i].impl) != 0)
+                continue;
+            double t = bench_encode();
+            report("encode", pattern, BENCH_DATA_SIZE, impls[i].name, mbytes / t, -1, -1, -1, base / t);
+        }
+    }
+    slip_scan_select(SLIP_SCAN_AUTO);
+
+    // slip_decoder_feed() over a stream of frames.
+    for (size_t d = 0; d < ARRAY_SIZE(densities); d++) {
+        fill(densities[d]);
+        fill_stream();
+        snprintf(pattern, sizeof(pattern), "%u%%", densities[d]);
+
+        double base = bench_decode_bytewise();
+        double fps = (double)(BENCH_DATA_SIZE + BENCH_FRAME_SIZE - 1) / BENCH_FRAME_SIZE * BENCH_ROUNDS;
+        report("decode", pattern, BENCH_FRAME_SIZE, "bytewise", mbytes / base, fps / base, -1, -1, 1.0);
+        for (size_t i = 0; i < ARRAY_SIZE(impls); i++) {
+            if (slip_scan_select(impls[i].impl) != 0)
+                continue;
+            double t = bench_decode();
+            report("decode", pattern, BENCH_FRAME_SIZE, impls[i].name, mbytes / t, fps / t, -1, -1, base / t);
+        }
+    }
+    slip_scan_select(SLIP_SCAN_AUTO);
+
+    // slip_decode_parallel() over a large capture, `pattern` is the escape density.
+    for (size_t d = 0; d < ARRAY_SIZE(densities); d++) {
+        fill(densities[d]);
+        fill_stream();
+        snprintf(pattern, sizeof(pattern), "%u%%", densities[d]);
+        bench_parallel(pattern);
+    }
+
+    // slip_send_frame() and slip_receive_frame() per frame, `pattern` is the payload.
+    for (size_t p = 0; p < ARRAY_SIZE(patterns); p++) {
+        fill_payload(patterns[p]);
+        for (size_t i = 0; i < ARRAY_SIZE(sizes); i++)
+            bench_frames(patterns[p], sizes[i]);
+    }
+
+    return 0;
+}
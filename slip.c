@@ -1,135 +1,928 @@
 #include "slip.h"
+#include "slip_scan.h"
+#include "spsc_ringbuffer.h"
+#include "slip_pool.h"
+#include "slip_crc.h"
+#include <limits.h>
 #include <stddef.h>
+#include <string.h>
+#include <time.h>
 
-/* SLIP special character codes */
-#define SLIP_END        0xC0    //  indicates end of packet
-#define SLIP_ESC        0xDB    //  indicates byte stuffing
-#define SLIP_ESC_END    0xDC    //  ESC ESC_END means END data byte
-#define SLIP_ESC_ESC    0xDD    //  ESC ESC_ESC means ESC data byte
+/* Plain runs at least this long are sent in place by a transport, shorter ones are copied. */
+#define SLIP_TRANSPORT_INPLACE_RUN  64
+#define SLIP_TRANSPORT_IOV          16
 
+_Static_assert((SLIP_RINGBUFFER_SIZE & (SLIP_RINGBUFFER_SIZE - 1)) == 0 && SLIP_RINGBUFFER_SIZE >= SLIP_MAX_BUFFER,
+               "SLIP_RINGBUFFER_SIZE must be a power of two not less than SLIP_MAX_BUFFER");
 
 int slip_init(struct slip *handler, struct slip_config *config)
+{
+    return slip_init_with_buffer(handler, config, NULL, 0, NULL, 0);
+}
+
+int slip_init_with_buffer(struct slip *handler, struct slip_config *config,
+                          uint8_t *rx_pool, uint32_t rx_size,
+                          uint8_t *tx_buffer, uint16_t tx_size)
 {
     SLIP_ASSERT(handler);
     SLIP_ASSERT(config);
+
+    if (rx_pool == NULL) {
+        rx_pool = handler->ringbuffer_pool;
+        rx_size = ARRAY_SIZE(handler->ringbuffer_pool);
+    }
+    if (rx_size == 0 || (tx_buffer && tx_size < 2))
+        return -1;
     
-    handler->state  = SLIP_UNKNOWN_STATE;
-    rt_ringbuffer_init(&handler->ringbuffer, handler->ringbuffer_pool, ARRAY_SIZE(handler->ringbuffer_pool));
+    slip_decoder_init(&handler->decoder, NULL, 0);
+    handler->decoder.fcs = config->fcs;
+    rt_ringbuffer_init(&handler->ringbuffer, rx_pool, rx_size);
     handler->config = config;
+    handler->tx_buffer = tx_buffer;
+    handler->tx_size = tx_size;
+    handler->rx_ring = NULL;
+    handler->frame_pool = NULL;
+    handler->transport = NULL;
+    memset(&handler->tx_stats, 0, sizeof(handler->tx_stats));
     return 0;
 }
 
 void slip_reset(struct slip *handler)
 {
-    handler->state = SLIP_UNKNOWN_STATE;
+    slip_decoder_reset(&handler->decoder);
     rt_ringbuffer_reset(&handler->ringbuffer);
 }
 
+void slip_set_rx_ring(struct slip *handler, struct spsc_ringbuffer *ring)
+{
+    SLIP_ASSERT(handler);
+
+    handler->rx_ring = ring;
+}
+
+void slip_set_frame_pool(struct slip *handler, struct slip_pool *pool)
+{
+    SLIP_ASSERT(handler);
+
+    handler->frame_pool = pool;
+}
+
+void slip_set_transport(struct slip *handler, const struct slip_transport *transport)
+{
+    SLIP_ASSERT(handler);
+    SLIP_ASSERT(transport == NULL || (transport->writev && transport->read));
+
+    handler->transport = transport;
+}
+
+/* Peek received bytes, receive more by `recv()` if there is none, -1 if the source is closed or failed. */
+static long slip_rx_peek(struct slip *handler, uint8_t *span[2], size_t span_length[2])
+{
+    if (handler->rx_ring)
+        return (long)spsc_ringbuffer_peek_span(handler->rx_ring, span, span_length);
+
+    struct rt_ringbuffer *rb = &handler->ringbuffer;
+    if (rt_ringbuffer_data_len(rb) == 0) {
+        // Empty, receive straight into the whole ring buffer.
+        rt_ringbuffer_reset(rb);
+        rt_ringbuffer_reserve_span(rb, span, span_length);
+        long size;
+        if (handler->transport) {
+            size = handler->transport->read(handler->transport->ctx, span[0], span_length[0]);
+        } else {
+            if (span_length[0] > UINT16_MAX)
+                span_length[0] = UINT16_MAX;
+            size = handler->config->recv(handler->config->user, span[0], span_length[0]);
+        }
+        // `read()` of a transport blocks, 0 is the end of the stream. `recv()` may have nothing.
+        if (size < 0 || (size == 0 && handler->transport))
+            return -1;
+        rt_ringbuffer_commit(rb, size);
+    }
+    return (long)rt_ringbuffer_peek_span(rb, span, span_length);
+}
+
+static void slip_rx_consume(struct slip *handler, size_t length)
+{
+    if (handler->rx_ring)
+        spsc_ringbuffer_consume(handler->rx_ring, length);
+    else
+        rt_ringbuffer_consume(&handler->ringbuffer, length);
+}
+
+/* Received bytes not decoded yet, nothing is read. */
+static size_t slip_rx_pending(struct slip *handler)
+{
+    uint8_t *span[2];
+    size_t span_length[2];
+
+    if (handler->rx_ring)
+        return spsc_ringbuffer_peek_span(handler->rx_ring, span, span_length);
+    return rt_ringbuffer_data_len(&handler->ringbuffer);
+}
+
+/* Sleep in the wait hook of the data source, without a hook data may be ready at once. */
+static int slip_rx_wait(struct slip *handler, int timeout_ms)
+{
+    if (handler->transport && !handler->rx_ring)
+        return handler->transport->wait ? handler->transport->wait(handler->transport->ctx, timeout_ms) : 1;
+    return handler->config->wait ? handler->config->wait(handler->config->user, timeout_ms) : 1;
+}
+
+/* Monotonic time in milliseconds, for receive timeouts. */
+static uint64_t slip_clock_ms(void)
+{
+    struct timespec ts;
+
+#if defined CLOCK_MONOTONIC
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+#else
+    timespec_get(&ts, TIME_UTC);
+#endif
+    return (uint64_t)ts.tv_sec * 1000 + (uint64_t)ts.tv_nsec / 1000000;
+}
+
+static int slip_remaining_ms(uint64_t deadline)
+{
+    uint64_t now = slip_clock_ms();
+
+    if (now >= deadline)
+        return 0;
+    return deadline - now > INT_MAX ? INT_MAX : (int)(deadline - now);
+}
+
+void slip_get_stats(const struct slip *handler, struct slip_stats *stats)
+{
+    SLIP_ASSERT(handler);
+    SLIP_ASSERT(stats);
+
+    stats->rx = handler->decoder.stats;
+    stats->tx = handler->tx_stats;
+}
+
+void slip_reset_stats(struct slip *handler)
+{
+    SLIP_ASSERT(handler);
+
+    memset(&handler->decoder.stats, 0, sizeof(handler->decoder.stats));
+    memset(&handler->tx_stats, 0, sizeof(handler->tx_stats));
+}
+
+/* Count a sent frame, each escape sequence adds one byte. */
+static void slip_tx_count(struct slip *handler, size_t payload, size_t bytes)
+{
+    handler->tx_stats.frames++;
+    handler->tx_stats.payload += payload;
+    handler->tx_stats.bytes   += bytes;
+    handler->tx_stats.escapes += bytes - 2 - payload - (handler->config->fcs ? SLIP_FCS_SIZE : 0);
+}
+
+static inline size_t slip_encode_crc(uint8_t *dst, size_t dst_len, const uint8_t *src, size_t src_len,
+                                     size_t *src_used, uint32_t *crc);
+
+/* FCS bytes of a CRC register, little endian. */
+static void slip_fcs_fill(uint8_t fcs[SLIP_FCS_SIZE], uint32_t crc)
+{
+    crc = ~crc;
+    for (int i = 0; i < SLIP_FCS_SIZE; i++)
+        fcs[i] = (uint8_t)(crc >> (8 * i));
+}
+
+void slip_set_frame_buffer(struct slip *handler, uint8_t *buffer, size_t size)
+{
+    SLIP_ASSERT(handler);
+    SLIP_ASSERT(buffer && size > 0);
+
+    handler->decoder.buffer = buffer;
+    handler->decoder.size   = size;
+    slip_decoder_reset(&handler->decoder);
+}
+
+int slip_input(struct slip *handler, const uint8_t *data, size_t length)
+{
+    SLIP_ASSERT(handler);
+    SLIP_ASSERT(handler->decoder.buffer);
+    SLIP_ASSERT(handler->config->on_frame);
+
+    struct slip_decoder *decoder = &handler->decoder;
+    size_t consumed;
+    int count = 0;
+
+    while (length > 0) {
+        int ret = slip_decoder_feed(decoder, data, length, &consumed);
+        data   += consumed;
+        length -= consumed;
+        if (ret > 0) {
+            handler->config->on_frame(handler->config->user, decoder->buffer, decoder->length);
+            count++;
+        }
+    }
+    return count;
+}
+
+int slip_poll(struct slip *handler)
+{
+    SLIP_ASSERT(handler);
+
+    uint8_t *span[2];
+    size_t span_length[2];
+    int count = 0;
+
+    if (slip_rx_peek(handler, span, span_length) < 0)
+        return -1;
+    for (int i = 0; i < 2; i++) {
+        count += slip_input(handler, span[i], span_length[i]);
+        slip_rx_consume(handler, span_length[i]);
+    }
+    return count;
+}
+
+/* Gather a frame for transport `writev()`, see `slip_set_transport()`. */
+static int slip_transport_sendv(struct slip *handler, const struct slip_iovec *iov, int iovcnt)
+{
+    const struct slip_transport *transport = handler->transport;
+    uint8_t stack_buffer[SLIP_MAX_BUFFER];
+    uint8_t *stage = handler->tx_buffer ? handler->tx_buffer : stack_buffer;
+    size_t size = handler->tx_buffer ? handler->tx_size : ARRAY_SIZE(stack_buffer);
+    struct slip_iovec out[SLIP_TRANSPORT_IOV];
+    size_t staged = 1, used, written, payload = 0, wire = 2;
+    int n = 1, open = 1;    // out[n - 1] ends at stage[staged] and can grow.
+    int fcs = handler->config->fcs;
+    uint8_t fcs_bytes[SLIP_FCS_SIZE];
+    uint32_t crc = SLIP_CRC32C_INIT;
+
+    stage[0] = SLIP_END;
+    out[0] = (struct slip_iovec) { stage, 1 };
+    // The FCS is encoded as one more segment.
+    for (int i = 0; i < iovcnt + fcs; i++) {
+        const uint8_t *data = fcs_bytes;
+        size_t length = SLIP_FCS_SIZE;
+
+        if (i < iovcnt) {
+            data   = iov[i].base;
+            length = iov[i].length;
+        } else {
+            slip_fcs_fill(fcs_bytes, crc);
+        }
+
+        while (length > 0) {
+            size_t run = slip_scan(data, length);
+
+            if (n == SLIP_TRANSPORT_IOV && (run >= SLIP_TRANSPORT_INPLACE_RUN || !open)) {
+                if (transport->writev(transport->ctx, out, n) < 0)
+                    return -1;
+                n = 0, staged = 0, open = 0;
+            }
+            if (run >= SLIP_TRANSPORT_INPLACE_RUN) {
+                if (fcs)
+                    crc = slip_crc32c_update(crc, data, run);
+                out[n++] = (struct slip_iovec) { data, run };
+                open = 0;
+                data    += run;
+                length  -= run;
+                payload += run;     // Never reached by the FCS, it is shorter.
+                wire    += run;
+                continue;
+            }
+
+            // Stage the short run with the special byte behind it.
+            written = slip_encode(&stage[staged], size - staged, data, run < length ? run + 1 : run, &used);
+            if (used == 0) {
+                // Send buffer is full.
+                if (transport->writev(transport->ctx, out, n) < 0)
+                    return -1;
+                n = 0, staged = 0, open = 0;
+                continue;
+            }
+            if (fcs && i < iovcnt)
+                crc = slip_crc32c_update(crc, data, used);
+            if (open) {
+                out[n - 1].length += written;
+            } else {
+                out[n++] = (struct slip_iovec) { &stage[staged], written };
+                open = 1;
+            }
+            staged  += written;
+            data    += used;
+            length  -= used;
+            payload += (i < iovcnt) ? used : 0;
+            wire    += written;
+        }
+    }
+
+    if (staged == size || (!open && n == SLIP_TRANSPORT_IOV)) {
+        if (transport->writev(transport->ctx, out, n) < 0)
+            return -1;
+        n = 0, staged = 0, open = 0;
+    }
+    stage[staged] = SLIP_END;
+    if (open)
+        out[n - 1].length++;
+    else
+        out[n++] = (struct slip_iovec) { &stage[staged], 1 };
+    if (transport->writev(transport->ctx, out, n) < 0)
+        return -1;
+    slip_tx_count(handler, payload, wire);
+    return 0;
+}
+
 int slip_send_frame(struct slip *handler, uint8_t *buffer, uint16_t length)
 {
     SLIP_ASSERT(handler);
     SLIP_ASSERT(buffer);
 
-    uint8_t send_buffer[SLIP_MAX_BUFFER];
+    if (handler->transport) {
+        struct slip_iovec iov = { buffer, length };
+        return slip_transport_sendv(handler, &iov, 1);
+    }
+
+    uint8_t stack_buffer[SLIP_MAX_BUFFER];
+    uint8_t *send_buffer = handler->tx_buffer ? handler->tx_buffer : stack_buffer;
+    size_t size = handler->tx_buffer ? handler->tx_size : ARRAY_SIZE(stack_buffer);
+    size_t fcs = handler->config->fcs ? 2 * SLIP_FCS_SIZE : 0;     // Escaped in the worst case.
+    uint8_t fcs_bytes[SLIP_FCS_SIZE];
+    uint32_t crc = SLIP_CRC32C_INIT;
     uint16_t idx = 0;
+    size_t used, fcs_used;
     
+    SLIP_ASSERT(size >= 2 + fcs);
+
     send_buffer[idx++] = SLIP_END;
-    for (uint16_t i = 0; i < length; i++) {
-        uint8_t c = buffer[i];
-        switch (c) {
-        case SLIP_END:  
-            send_buffer[idx++] = SLIP_ESC;
-            c = SLIP_ESC_END;
-            break;
-        case SLIP_ESC:
-            send_buffer[idx++] = SLIP_ESC;
-            c = SLIP_ESC_ESC;
-            break;
-        default:    break;
+    // Leave the last byte for END (and FCS), data that does not fit will be truncated.
+    idx += slip_encode_crc(&send_buffer[idx], size - 2 - fcs, buffer, length, &used, fcs ? &crc : NULL);
+    if (fcs) {
+        // A valid FCS over a truncated frame would hide the truncation from the receiver.
+        if (used < length)
+            return -1;
+        slip_fcs_fill(fcs_bytes, crc);
+        idx += slip_encode(&send_buffer[idx], fcs, fcs_bytes, SLIP_FCS_SIZE, &fcs_used);
+    }
+    send_buffer[idx++] = SLIP_END;
+
+    handler->config->send(handler->config->user, send_buffer, idx);
+    slip_tx_count(handler, used, idx);
+    if (used < length)
+        handler->tx_stats.truncations++;
+
+    return 0;
+}
+
+int slip_send_framev(struct slip *handler, const struct slip_iovec *iov, int iovcnt)
+{
+    SLIP_ASSERT(handler);
+    SLIP_ASSERT(iov || iovcnt == 0);
+
+    if (handler->transport)
+        return slip_transport_sendv(handler, iov, iovcnt);
+
+    uint8_t stack_buffer[SLIP_MAX_BUFFER];
+    uint8_t *chunk = handler->tx_buffer ? handler->tx_buffer : stack_buffer;
+    size_t size = handler->tx_buffer ? handler->tx_size : ARRAY_SIZE(stack_buffer);
+    size_t chunk_size = handler->config->chunk_size;
+    size_t idx = 0, used, payload = 0, wire = 0;
+    int fcs = handler->config->fcs;
+    uint8_t fcs_bytes[SLIP_FCS_SIZE];
+    uint32_t crc = SLIP_CRC32C_INIT;
+
+    if (chunk_size == 0 || chunk_size > size)
+        chunk_size = size;
+    SLIP_ASSERT(chunk_size >= 2);   // Room for an escape sequence.
+
+    chunk[idx++] = SLIP_END;
+    // The FCS is encoded as one more segment.
+    for (int i = 0; i < iovcnt + fcs; i++) {
+        const uint8_t *data = fcs_bytes;
+        size_t length = SLIP_FCS_SIZE;
+
+        if (i < iovcnt) {
+            data   = iov[i].base;
+            length = iov[i].length;
+        } else {
+            slip_fcs_fill(fcs_bytes, crc);
         }
-        // Check index, used to truncate buffer.
-        if (idx >= SLIP_MAX_BUFFER-1)
-            break;
 
-        send_buffer[idx++] = c;
+        while (length > 0) {
+            idx += slip_encode_crc(&chunk[idx], chunk_size - idx, data, length, &used,
+                                   (fcs && i < iovcnt) ? &crc : NULL);
+            if (i < iovcnt)
+                payload += used;
+            data    += used;
+            length  -= used;
+            // Chunk is full.
+            if (length > 0) {
+                handler->config->send(handler->config->user, chunk, idx);
+                wire += idx;
+                idx = 0;
+            }
+        }
+    }
+    if (idx >= chunk_size) {
+        handler->config->send(handler->config->user, chunk, idx);
+        wire += idx;
+        idx = 0;
+    }
+    chunk[idx++] = SLIP_END;
+    handler->config->send(handler->config->user, chunk, idx);
+    slip_tx_count(handler, payload, wire + idx);
+
+    return 0;
+}
+
+size_t slip_encode(uint8_t *dst, size_t dst_len, const uint8_t *src, size_t src_len, size_t *src_used)
+{
+    return slip_encode_crc(dst, dst_len, src, src_len, src_used, NULL);
+}
+
+/* `slip_encode()`, and update `crc` (if not NULL) with the encoded bytes while they are in cache. */
+static inline size_t slip_encode_crc(uint8_t *dst, size_t dst_len, const uint8_t *src, size_t src_len,
+                                     size_t *src_used, uint32_t *crc)
+{
+    SLIP_ASSERT(dst || dst_len == 0);
+    SLIP_ASSERT(src || src_len == 0);
+    SLIP_ASSERT(src_used);
+
+    size_t i = 0, idx = 0, mark = 0;    // Bytes from `mark` on are not in `crc` yet.
+    while (i < src_len) {
+        uint8_t c = src[i];
+        if (c == SLIP_END || c == SLIP_ESC) {
+            // Never split an escape sequence.
+            if (dst_len - idx < 2)
+                break;
+            dst[idx++] = SLIP_ESC;
+            dst[idx++] = (c == SLIP_END) ? SLIP_ESC_END : SLIP_ESC_ESC;
+            i++;
+            continue;
+        }
 
-        // Check index, used to truncate buffer.
-        if (idx >= SLIP_MAX_BUFFER-1)
+        // Short runs are copied inline, long runs are scanned and copied in bulk.
+        if (idx >= dst_len)
             break;
+        if (i + 1 >= src_len || src[i + 1] == SLIP_END || src[i + 1] == SLIP_ESC) {
+            dst[idx++] = c;
+            i++;
+            continue;
+        }
+
+        size_t run = slip_scan(&src[i], src_len - i);
+        if (run > dst_len - idx)
+            run = dst_len - idx;
+        if (run == 0)
+            break;
+        memcpy(&dst[idx], &src[i], run);
+        idx += run;
+        i   += run;
+        if (crc) {
+            *crc = slip_crc32c_update(*crc, &src[mark], i - mark);
+            mark = i;
+        }
     }
-    send_buffer[idx++] = SLIP_END;
 
-    handler->config->send(send_buffer, idx);
+    if (crc)
+        *crc = slip_crc32c_update(*crc, &src[mark], i - mark);
+    *src_used = i;
+    return idx;
+}
+
+static int slip_receive_frames_timeout(struct slip *handler, uint8_t *buffer, size_t length,
+                                       struct slip_frame *frames, int max_frames, int timeout_ms);
 
+int slip_receive_frame(struct slip *handler, uint8_t *buffer, uint16_t length, uint16_t *recv_length)
+{
+    return slip_receive_frame_timeout(handler, buffer, length, recv_length, -1);
+}
+
+int slip_receive_frame_timeout(struct slip *handler, uint8_t *buffer, uint16_t length, uint16_t *recv_length,
+                               int timeout_ms)
+{
+    SLIP_ASSERT(recv_length);
+
+    struct slip_frame frame = { 0, 0 };
+    int ret = slip_receive_frames_timeout(handler, buffer, length, &frame, 1, timeout_ms);
+    if (ret < 0)
+        return ret;     // Buffer is not enough to store frame, timeout or closed.
+
+    *recv_length = frame.length;
     return 0;
 }
 
-int slip_receive_frame(struct slip *handler, uint8_t *buffer, uint16_t length, uint16_t *recv_length)
+int slip_receive_frame_pooled(struct slip *handler, uint8_t **frame, uint16_t *recv_length)
 {
     SLIP_ASSERT(handler);
-    SLIP_ASSERT(buffer);
+    SLIP_ASSERT(handler->frame_pool);
+    SLIP_ASSERT(frame);
     SLIP_ASSERT(recv_length);
+
+    struct slip_pool *pool = handler->frame_pool;
+    struct slip_frame received;
+
+    uint8_t *block = slip_pool_acquire(pool);
+    if (block == NULL)
+        return -2;      // Pool is empty, received bytes are kept.
+
+    int ret = slip_receive_frames(handler, block, pool->block_size, &received, 1);
+    if (ret < 0) {
+        slip_pool_release(pool, block);
+        return ret;     // Block is not enough to store frame, or closed.
+    }
+
+    *frame = block;
+    *recv_length = received.length;
+    return 0;
+}
+
+int slip_receive_frames(struct slip *handler, uint8_t *buffer, size_t length, struct slip_frame *frames, int max_frames)
+{
+    return slip_receive_frames_timeout(handler, buffer, length, frames, max_frames, -1);
+}
+
+static int slip_receive_frames_timeout(struct slip *handler, uint8_t *buffer, size_t length,
+                                       struct slip_frame *frames, int max_frames, int timeout_ms)
+{
+    SLIP_ASSERT(handler);
+    SLIP_ASSERT(buffer);
+    SLIP_ASSERT(frames);
     SLIP_ASSERT(length > 0);
+    SLIP_ASSERT(max_frames > 0);
 
-    struct rt_ringbuffer *rb = &handler->ringbuffer;
+    struct slip_decoder *decoder = &handler->decoder;
 
-    uint16_t idx = 0;
-    int size = 0;
-    uint8_t temp_buf[SLIP_MAX_BUFFER];
+    int count = 0;
+    uint64_t deadline = timeout_ms >= 0 ? slip_clock_ms() + (uint64_t)timeout_ms : 0;
+
+    // A frame left incomplete by an earlier call is in the buffer of that call, drop it if this one differs.
+    if ((decoder->state == SLIP_DECODING_STATE || decoder->state == SLIP_ESCAPE_STATE)
+        && (decoder->buffer != buffer || decoder->length > length)) {
+        decoder->state = SLIP_ERROR_STATE;
+        decoder->stats.oversize++;
+    }
+    decoder->buffer = buffer;
+    decoder->size   = length;
     while (1) {
-        if (rt_ringbuffer_data_len(rb) == 0) {
-            size = handler->config->recv(temp_buf, ARRAY_SIZE(temp_buf));
-            if (size <= 0)
-                continue;
+        uint8_t *span[2];
+        size_t span_length[2];
+        // A read may block, so with a timeout wait before it.
+        if (timeout_ms >= 0 && slip_rx_pending(handler) == 0) {
+            int ready = slip_rx_wait(handler, slip_remaining_ms(deadline));
+            if (ready < 0)
+                return -3;      // Transport is closed or failed.
+            if (ready == 0)
+                return -2;
+        }
+        long received = slip_rx_peek(handler, span, span_length);
+        if (received < 0)
+            return -3;
+        if (received == 0) {
+            // Nothing received, sleep in the wait hook instead of spinning.
+            if (timeout_ms < 0) {
+                if (slip_rx_wait(handler, -1) < 0)
+                    return -3;
+            } else if (slip_clock_ms() >= deadline) {
+                return -2;
+            }
+            continue;
         }
-        
-        uint8_t ch;
-        rt_ringbuffer_put_force(rb, temp_buf, size);
-        while (rt_ringbuffer_data_len(rb) > 0) {
-            rt_ringbuffer_getchar(rb, &ch);
 
-            switch (handler->state) {
-            case SLIP_UNKNOWN_STATE:
-                if (ch == SLIP_END)
-                    handler->state = SLIP_FRAME_START_STATE;
-                break;
-            case SLIP_FRAME_START_STATE:
-                if (ch == SLIP_END)
+        // Decode the received bytes in place, span by span.
+        size_t used = 0, mark = 0, pos, consumed;
+        struct slip_rx_stats mark_stats = decoder->stats;
+        int full = 0;
+        for (int i = 0; i < 2 && !full; i++) {
+            for (pos = 0; pos < span_length[i] && count < max_frames; pos += consumed) {
+                int ret = slip_decoder_feed(decoder, &span[i][pos], span_length[i] - pos, &consumed);
+                if (ret > 0) {
+                    // Success receive a frame, next one is stored behind it.
+                    frames[count].offset = decoder->buffer - buffer;
+                    frames[count].length = decoder->length;
+                    count++;
+                    decoder->buffer += decoder->length;
+                    decoder->size   -= decoder->length;
+                    mark = used + pos + consumed;
+                    mark_stats = decoder->stats;
+                } else if (ret < 0) {
+                    if (count == 0) {
+                        slip_rx_consume(handler, used + pos + consumed);
+                        return -1;      // Buffer is not enough to store frame.
+                    }
+                    full = 1;
                     break;
-                handler->state = SLIP_DECODING_STATE;
-                // fall through
-            case SLIP_DECODING_STATE:
-                if (ch == SLIP_ESC) {
-                    rt_ringbuffer_getchar(rb, &ch);
-                    SLIP_ASSERT(ch == SLIP_ESC_END || ch == SLIP_ESC_ESC);
-                    buffer[idx++] = (ch == SLIP_ESC_END) ? SLIP_END : SLIP_ESC;
-                } else if (ch == SLIP_END) {
-                    handler->state = SLIP_FRAME_END_STATE;
-                    // Success receive a frame.
-                    *recv_length = idx;
-                    return 0;
-                } else {
-                    buffer[idx++] = ch;
                 }
-                break;
-            case SLIP_FRAME_END_STATE:
-                if (ch == SLIP_END)
-                    handler->state = SLIP_DECODING_STATE;
-                else 
-                    handler->state = SLIP_ERROR_STATE;
-                break;
-            case SLIP_ERROR_STATE:
-                if (ch == SLIP_END)
-                    handler->state = SLIP_FRAME_END_STATE;
-                break;
-            default:    break;
             }
+            used += pos;
+            full = full || count == max_frames;
+        }
 
-            if (idx >= length)
-                return -1;      // Buffer is not enough to store frame.
+        if (count > 0) {
+            // Leave bytes behind the last frame to next receive, rewind the state and counters as well.
+            decoder->state = SLIP_FRAME_END_STATE;
+            decoder->stats = mark_stats;
+            slip_rx_consume(handler, mark);
+            return count;
         }
+        slip_rx_consume(handler, used);
+        // Bytes trickling in never reach the wait above, the deadline is checked here too.
+        if (timeout_ms >= 0 && slip_clock_ms() >= deadline)
+            return -2;
     }
 
     return -1;
 }
 
+void slip_decoder_init(struct slip_decoder *decoder, uint8_t *buffer, size_t size)
+{
+    SLIP_ASSERT(decoder);
+
+    decoder->buffer = buffer;
+    decoder->size   = size;
+    decoder->fcs    = 0;
+    memset(&decoder->stats, 0, sizeof(decoder->stats));
+    slip_decoder_reset(decoder);
+}
+
+void slip_decoder_reset(struct slip_decoder *decoder)
+{
+    decoder->state  = SLIP_UNKNOWN_STATE;
+    decoder->length = 0;
+    decoder->crc    = SLIP_CRC32C_INIT;
+    decoder->crc_length = 0;
+}
+
+/* Feed the decoded bytes not checked yet to the CRC register, they are still in cache. */
+static inline void slip_decoder_crc(struct slip_decoder *decoder)
+{
+    decoder->crc = slip_crc32c_update(decoder->crc, &decoder->buffer[decoder->crc_length],
+                                      decoder->length - decoder->crc_length);
+    decoder->crc_length = decoder->length;
+}
+
+/* Test whether none of the 8 bytes at `data` is SLIP_END or SLIP_ESC. */
+static inline int slip_plain8(const uint8_t *data)
+{
+    const uint64_t ones = 0x0101010101010101ull, highs = 0x8080808080808080ull;
+    uint64_t v, end, esc;
+
+    memcpy(&v, data, sizeof(v));
+    end = v ^ (ones * SLIP_END);
+    esc = v ^ (ones * SLIP_ESC);
+    return !(((end - ones) & ~end & highs) | ((esc - ones) & ~esc & highs));
+}
+
+/* Byte classes of the decoder. */
+enum {
+    SLIP_CLASS_PLAIN = 0,
+    SLIP_CLASS_END,
+    SLIP_CLASS_ESC,
+    SLIP_CLASS_ESC_END,
+    SLIP_CLASS_ESC_ESC,
+    SLIP_CLASS_COUNT,
+};
+
+static const uint8_t slip_byte_class[256] = {
+    [SLIP_END]     = SLIP_CLASS_END,
+    [SLIP_ESC]     = SLIP_CLASS_ESC,
+    [SLIP_ESC_END] = SLIP_CLASS_ESC_END,
+    [SLIP_ESC_ESC] = SLIP_CLASS_ESC_ESC,
+};
+
+/* Decoder actions, several may be taken on one byte. */
+#define SLIP_ACT_START      0x01    // Start a frame.
+#define SLIP_ACT_STORE      0x02    // Store the byte xor `mask`.
+#define SLIP_ACT_FRAME      0x04    // Frame is complete.
+#define SLIP_ACT_ESCAPE     0x08    // Count an escape sequence.
+#define SLIP_ACT_DISCARD    0x10    // Count a discarded byte.
+#define SLIP_ACT_FRAMING    0x20    // Count a framing error.
+#define SLIP_ACT_BAD_ESCAPE 0x40    // Invalid escape sequence, drop the frame.
+
+/* Rare actions, checked with one test. */
+#define SLIP_ACT_RARE       (SLIP_ACT_FRAME | SLIP_ACT_FRAMING | SLIP_ACT_BAD_ESCAPE)
+
+/* Padded to 4 bytes, the table index is a shift on the state dependency chain. */
+struct slip_transition {
+    uint8_t next;
+    uint8_t action;
+    uint8_t mask;
+    uint8_t reserved;
+};
+
+#define T(next, action)         { SLIP_##next##_STATE, (action), 0, 0 }
+#define T_UNESCAPE(to)          { SLIP_DECODING_STATE, SLIP_ACT_STORE, (to), 0 }
+
+/* State machine of docs/decoder.plantuml, see `slip_decoder_feed()`. */
+static const struct slip_transition slip_transitions[][SLIP_CLASS_COUNT] = {
+    [SLIP_UNKNOWN_STATE] = {
+        [SLIP_CLASS_PLAIN]   = T(UNKNOWN, SLIP_ACT_DISCARD),
+        [SLIP_CLASS_END]     = T(FRAME_START, 0),
+        [SLIP_CLASS_ESC]     = T(UNKNOWN, SLIP_ACT_DISCARD),
+        [SLIP_CLASS_ESC_END] = T(UNKNOWN, SLIP_ACT_DISCARD),
+        [SLIP_CLASS_ESC_ESC] = T(UNKNOWN, SLIP_ACT_DISCARD),
+    },
+    [SLIP_FRAME_START_STATE] = {
+        [SLIP_CLASS_PLAIN]   = T(DECODING, SLIP_ACT_START | SLIP_ACT_STORE),
+        [SLIP_CLASS_END]     = T(FRAME_START, 0),
+        [SLIP_CLASS_ESC]     = T(ESCAPE, SLIP_ACT_START | SLIP_ACT_ESCAPE),
+        [SLIP_CLASS_ESC_END] = T(DECODING, SLIP_ACT_START | SLIP_ACT_STORE),
+        [SLIP_CLASS_ESC_ESC] = T(DECODING, SLIP_ACT_START | SLIP_ACT_STORE),
+    },
+    [SLIP_DECODING_STATE] = {
+        [SLIP_CLASS_PLAIN]   = T(DECODING, SLIP_ACT_STORE),
+        [SLIP_CLASS_END]     = T(FRAME_END, SLIP_ACT_FRAME),
+        [SLIP_CLASS_ESC]     = T(ESCAPE, SLIP_ACT_ESCAPE),
+        [SLIP_CLASS_ESC_END] = T(DECODING, SLIP_ACT_STORE),
+        [SLIP_CLASS_ESC_ESC] = T(DECODING, SLIP_ACT_STORE),
+    },
+    [SLIP_FRAME_END_STATE] = {
+        [SLIP_CLASS_PLAIN]   = T(ERROR, SLIP_ACT_FRAMING | SLIP_ACT_DISCARD),
+        [SLIP_CLASS_END]     = T(DECODING, SLIP_ACT_START),
+        [SLIP_CLASS_ESC]     = T(ERROR, SLIP_ACT_FRAMING | SLIP_ACT_DISCARD),
+        [SLIP_CLASS_ESC_END] = T(ERROR, SLIP_ACT_FRAMING | SLIP_ACT_DISCARD),
+        [SLIP_CLASS_ESC_ESC] = T(ERROR, SLIP_ACT_FRAMING | SLIP_ACT_DISCARD),
+    },
+    [SLIP_ERROR_STATE] = {
+        [SLIP_CLASS_PLAIN]   = T(ERROR, SLIP_ACT_DISCARD),
+        [SLIP_CLASS_END]     = T(FRAME_END, 0),
+        [SLIP_CLASS_ESC]     = T(ERROR, SLIP_ACT_DISCARD),
+        [SLIP_CLASS_ESC_END] = T(ERROR, SLIP_ACT_DISCARD),
+        [SLIP_CLASS_ESC_ESC] = T(ERROR, SLIP_ACT_DISCARD),
+    },
+    // A bad escape drops the frame, the SLIP_END closing it is not skipped.
+    [SLIP_ESCAPE_STATE] = {
+        [SLIP_CLASS_PLAIN]   = T(ERROR, SLIP_ACT_BAD_ESCAPE | SLIP_ACT_DISCARD),
+        [SLIP_CLASS_END]     = T(FRAME_END, SLIP_ACT_BAD_ESCAPE),
+        [SLIP_CLASS_ESC]     = T(ERROR, SLIP_ACT_BAD_ESCAPE | SLIP_ACT_DISCARD),
+        [SLIP_CLASS_ESC_END] = T_UNESCAPE(SLIP_ESC_END ^ SLIP_END),
+        [SLIP_CLASS_ESC_ESC] = T_UNESCAPE(SLIP_ESC_ESC ^ SLIP_ESC),
+    },
+};
+
+#undef T
+#undef T_UNESCAPE
+
+/* Length of the bytes before the next SLIP_END, memchr() is vectorized by the C library. */
+static inline size_t slip_skip_to_end(const uint8_t *data, size_t length)
+{
+    const uint8_t *end = memchr(data, SLIP_END, length);
+    return end ? (size_t)(end - data) : length;
+}
+
+int slip_decoder_feed(struct slip_decoder *decoder, const uint8_t *data, size_t length, size_t *consumed)
+{
+    SLIP_ASSERT(decoder);
+    SLIP_ASSERT(data || length == 0);
+    SLIP_ASSERT(consumed);
+
+    // Kept in locals, stores to the frame buffer may alias the decoder.
+    uint8_t *buffer = decoder->buffer;
+    size_t size = decoder->size, decoded = decoder->length;
+    unsigned state = decoder->state;
+    size_t i = 0, escapes = 0, discarded = 0;
+    int ret = 0;
+
+    // Resynchronize, bytes up to the next SLIP_END are discarded in one scan.
+    if (state == SLIP_UNKNOWN_STATE || state == SLIP_ERROR_STATE) {
+        i = slip_skip_to_end(data, length);
+        discarded = i;
+    }
+
+    while (i < length) {
+        // Fast path, copy a long run of plain bytes in bulk.
+        if (state == SLIP_DECODING_STATE && i + 8 <= length && slip_plain8(&data[i])) {
+            size_t run = slip_scan(&data[i], length - i);
+            if (decoded > size || run > size - decoded) {
+                i += (decoded < size ? size - decoded : 0) + 1;
+                state = SLIP_ERROR_STATE;
+                decoder->stats.oversize++;
+                ret = -1;       // Buffer is not enough, drop the frame.
+                goto out;
+            }
+            // memmove(), decoding in place is allowed.
+            memmove(&buffer[decoded], &data[i], run);
+            decoded += run;
+            i += run;
+            if (decoder->fcs) {
+                decoder->length = decoded;
+                slip_decoder_crc(decoder);
+            }
+            if (i >= length)
+                break;
+        }
+
+        // Short runs and escape sequences in a frame, without the table. A run of a few
+        // plain bytes goes back to the bulk copy if it is long. Frame ends, bad or split
+        // escapes and a full buffer are left to the table.
+        if (state == SLIP_DECODING_STATE) {
+            size_t start = i, plain = 0;
+            while (decoded < size && i + 1 < length) {
+                uint8_t ch = data[i], next = data[i + 1];
+                if (ch != SLIP_END && ch != SLIP_ESC) {
+                    buffer[decoded++] = ch;
+                    i++;
+                    if (++plain == 4 && i + 8 <= length && slip_plain8(&data[i]))
+                        break;
+                } else if (ch == SLIP_ESC && (next == SLIP_ESC_END || next == SLIP_ESC_ESC)) {
+                    buffer[decoded++] = (next == SLIP_ESC_END) ? SLIP_END : SLIP_ESC;
+                    escapes++;
+                    i += 2;
+                    plain = 0;
+                } else {
+                    break;
+                }
+            }
+            if (i != start)
+                continue;
+        }
+
+        uint8_t ch = data[i++];
+        const struct slip_transition *t = &slip_transitions[state][slip_byte_class[ch]];
+        unsigned action = t->action;
+
+        state = t->next;
+        escapes   += (action & SLIP_ACT_ESCAPE) != 0;
+        discarded += (action & SLIP_ACT_DISCARD) != 0;
+        if (action & SLIP_ACT_START) {
+            decoded = 0;
+            decoder->crc = SLIP_CRC32C_INIT;
+            decoder->crc_length = 0;
+        }
+        if (action & SLIP_ACT_STORE) {
+            if (decoded >= size) {
+                state = SLIP_ERROR_STATE;
+                decoder->stats.oversize++;
+                ret = -1;       // Buffer is not enough, drop the frame.
+                goto out;
+            }
+            buffer[decoded++] = ch ^ t->mask;
+        }
+        if (!(action & SLIP_ACT_RARE))
+            continue;
+
+        if (action & (SLIP_ACT_FRAMING | SLIP_ACT_BAD_ESCAPE)) {
+            decoder->stats.framing_errors += (action & SLIP_ACT_FRAMING) != 0;
+            decoder->stats.bad_escapes    += (action & SLIP_ACT_BAD_ESCAPE) != 0;
+            if (state == SLIP_ERROR_STATE) {
+                size_t skip = slip_skip_to_end(&data[i], length - i);
+                i += skip;
+                discarded += skip;
+            }
+            continue;
+        }
+        if (action & SLIP_ACT_FRAME) {
+            if (decoder->fcs) {
+                decoder->length = decoded;
+                slip_decoder_crc(decoder);
+                if (decoded < SLIP_FCS_SIZE || decoder->crc != SLIP_CRC32C_RESIDUE) {
+                    decoder->stats.fcs_errors++;
+                    continue;   // Drop the frame.
+                }
+                decoded -= SLIP_FCS_SIZE;
+            }
+            decoder->stats.frames++;
+            decoder->stats.payload += decoded;
+            ret = 1;            // Success decode a frame.
+            goto out;
+        }
+    }
+
+out:
+    decoder->state  = state;
+    decoder->length = decoded;
+    if (decoder->fcs && (state == SLIP_DECODING_STATE || state == SLIP_ESCAPE_STATE))
+        slip_decoder_crc(decoder);
+    decoder->stats.bytes     += i;
+    decoder->stats.escapes   += escapes;
+    decoder->stats.discarded += discarded;
+    *consumed = i;
+    return ret;
+}
+
+int slip_decode_inplace(uint8_t *buffer, size_t length, struct slip_frame *frames, int max_frames, size_t *consumed)
+{
+    SLIP_ASSERT(buffer || length == 0);
+    SLIP_ASSERT(frames || max_frames == 0);
+    SLIP_ASSERT(consumed);
+
+    struct slip_decoder decoder;
+    size_t rd = 0, wr = 0, used;
+    int count = 0;
+
+    // Decoded bytes are written behind the read position, never overwrite unread bytes.
+    slip_decoder_init(&decoder, buffer, length);
+    *consumed = 0;
+    while (rd < length && count < max_frames) {
+        int ret = slip_decoder_feed(&decoder, &buffer[rd], length - rd, &used);
+        rd += used;
+        if (ret > 0) {
+            frames[count].offset = wr;
+            frames[count].length = decoder.length;
+            count++;
+            wr += decoder.length;
+            decoder.buffer = &buffer[wr];
+            decoder.size   = length - wr;
+            *consumed = rd;
+        }
+    }
+
+    // No frame is pending, the rest bytes are garbage.
+    if (rd == length && (decoder.state == SLIP_UNKNOWN_STATE || decoder.state == SLIP_ERROR_STATE))
+        *consumed = length;
+
+    return count;
+}
@@ -3,6 +3,7 @@
 
 #include "ringbuffer.h"
 #include <stdint.h>
+#include <stddef.h>
 #include <assert.h>
 
 #if defined __cplusplus
@@ -11,6 +12,15 @@ extern "C" {
 
 #define SLIP_MAX_BUFFER 100
 
+/* Receive ring buffer size, a power of two not less than SLIP_MAX_BUFFER. */
+#define SLIP_RINGBUFFER_SIZE 128
+
+/* SLIP special character codes */
+#define SLIP_END        0xC0    //  indicates end of packet
+#define SLIP_ESC        0xDB    //  indicates byte stuffing
+#define SLIP_ESC_END    0xDC    //  ESC ESC_END means END data byte
+#define SLIP_ESC_ESC    0xDD    //  ESC ESC_ESC means ESC data byte
+
 #define SLIP_ASSERT assert
 
 #define ARRAY_SIZE(array)   (sizeof(array) / sizeof(array[0]))
@@ -21,26 +31,159 @@ typedef enum {
     SLIP_DECODING_STATE,
     SLIP_FRAME_END_STATE,
     SLIP_ERROR_STATE,
+    SLIP_ESCAPE_STATE,
 } SLIP_DECODER_STATE;
 
-struct slip {
+/* Receive counters, kept by the decoder. */
+struct slip_rx_stats {
+    uint64_t frames;            /* Decoded frames. */
+    uint64_t bytes;             /* Bytes fed to the decoder, as on the wire. */
+    uint64_t payload;           /* Payload bytes of decoded frames. */
+    uint64_t escapes;           /* Escape sequences. */
+    uint64_t framing_errors;    /* Data between frames, the rest up to next END is discarded. */
+    uint64_t bad_escapes;       /* Frames dropped for SLIP_ESC not followed by ESC_END/ESC_ESC. */
+    uint64_t oversize;          /* Frames dropped for being longer than the frame buffer. */
+    uint64_t fcs_errors;        /* Frames dropped for a bad or missing FCS. */
+    uint64_t discarded;         /* Bytes skipped while searching for END. */
+};
+
+/* Send counters. */
+struct slip_tx_stats {
+    uint64_t frames;            /* Sent frames. */
+    uint64_t bytes;             /* Encoded bytes, as on the wire. */
+    uint64_t payload;           /* Payload bytes of sent frames. */
+    uint64_t escapes;           /* Escape sequences. */
+    uint64_t truncations;       /* Frames truncated by `slip_send_frame()`. */
+};
+
+/* Link statistics, see `slip_get_stats()`. */
+struct slip_stats {
+    struct slip_rx_stats rx;
+    struct slip_tx_stats tx;
+};
+
+/**
+ * Incremental decoder, keeps the decoding state between calls so that it
+ * can be fed with whatever bytes are at hand (event loop, ISR, DMA ...).
+ */
+struct slip_decoder {
     SLIP_DECODER_STATE state;
+    uint8_t *buffer;        /* Frame buffer. */
+    size_t size;            /* Frame buffer size. */
+    size_t length;          /* Decoded length of the current frame. */
+    struct slip_rx_stats stats;
+    /* Check and strip the CRC-32C FCS of frames, see slip_crc.h. */
+    int fcs;
+    uint32_t crc;           /* CRC register of the current frame. */
+    size_t crc_length;      /* Decoded bytes fed to `crc`. */
+};
+
+/* Decoded frame location, see `slip_decode_inplace()`. */
+struct slip_frame {
+    size_t offset;
+    size_t length;
+};
+
+struct spsc_ringbuffer;
+struct slip_pool;
+struct slip_transport;
+
+struct slip {
+    struct slip_decoder decoder;
     struct rt_ringbuffer ringbuffer;
-    uint8_t ringbuffer_pool[SLIP_MAX_BUFFER];
+    uint8_t ringbuffer_pool[SLIP_RINGBUFFER_SIZE];
     struct slip_config *config;
+    /* Send buffer, NULL means SLIP_MAX_BUFFER on stack, see `slip_init_with_buffer()`. */
+    uint8_t *tx_buffer;
+    uint16_t tx_size;
+    /* Filled by another thread instead of `recv()`, see `slip_set_rx_ring()`. */
+    struct spsc_ringbuffer *rx_ring;
+    /* Received frames are stored in it, see `slip_receive_frame_pooled()`. */
+    struct slip_pool *frame_pool;
+    /* Used instead of `send()`/`recv()`, see `slip_set_transport()`. */
+    const struct slip_transport *transport;
+    struct slip_tx_stats tx_stats;
 };
 struct slip_config {
     /* Send data to uart. */
-    void (*send)(uint8_t *buffer, uint16_t length);
+    void (*send)(void *user, uint8_t *buffer, uint16_t length);
 
     /**
      * @brief Receive data from uart.
      * 
      * @return int
-     * @retval >=0   Receive data length.
+     * @retval >=0   Receive data length, 0 if nothing is received yet.
      * @return -1    Error.
     */
-    int (*recv)(uint8_t *buffer, uint16_t length);
+    int (*recv)(void *user, uint8_t *buffer, uint16_t length);
+
+    /* Called with every complete frame by `slip_input()` and `slip_poll()`, optional. */
+    void (*on_frame)(void *user, const uint8_t *frame, size_t length);
+
+    /* Context passed to all callbacks above. */
+    void *user;
+
+    /* Max length of each `send()` call in `slip_send_framev()`, 0 means the send buffer size. */
+    uint16_t chunk_size;
+
+    /**
+     * Append a CRC-32C frame check sequence (4 bytes, little endian) to sent frames,
+     * check and strip it from received ones, frames with a bad FCS are dropped.
+     * Frame buffers must have room for the payload and the FCS.
+     */
+    uint8_t fcs;
+
+    /**
+     * @brief Sleep until `recv()` (or the rx ring) has data, optional.
+     * 
+     * The receive functions call it instead of polling `recv()` again when nothing
+     * was received, e.g. poll() on a fd, or an eventfd or condition variable
+     * signaled by the producer of the rx ring.
+     * 
+     * @param timeout_ms    Max time to wait in milliseconds, -1 to wait forever.
+     * 
+     * @return int
+     * @retval 1     Data may be ready.
+     * @retval 0     Timeout.
+     * @retval -1    Error.
+    */
+    int (*wait)(void *user, int timeout_ms);
+};
+
+/* A segment of frame payload, see `slip_send_framev()`. */
+struct slip_iovec {
+    const uint8_t *base;
+    size_t length;
+};
+
+/**
+ * Byte stream transport bound to a handler, e.g. a file descriptor (see slip_posix.h).
+ * Unlike `slip_config` it carries a context and moves data in large gathered blocks.
+ */
+struct slip_transport {
+    /**
+     * @brief Write all segments.
+     * 
+     * @return int
+     * @retval 0     Success.
+     * @retval -1    Error.
+    */
+    int (*writev)(void *ctx, const struct slip_iovec *iov, int iovcnt);
+
+    /**
+     * @brief Read up to `length` bytes, block until some are read.
+     * 
+     * @return long
+     * @retval >0    Read data length.
+     * @retval 0     End of stream.
+     * @retval -1    Error.
+    */
+    long (*read)(void *ctx, uint8_t *buffer, size_t length);
+
+    void *ctx;
+
+    /* Sleep until `read()` has data, optional, same as `wait()` in `slip_config`. */
+    int (*wait)(void *ctx, int timeout_ms);
 };
 
 /**
@@ -55,6 +198,24 @@ struct slip_config {
 */
 int slip_init(struct slip *handler, struct slip_config *config);
 
+/**
+ * @brief Init a slip handler with caller supplied buffers, so each link can be sized for its MTU.
+ * 
+ * @param handler   slip handler point. 
+ * @param config    slip configuration structure.
+ * @param rx_pool   Receive ring buffer memory, NULL to use the one in handler.
+ * @param rx_size   Receive ring buffer size, rounded down to a power of two.
+ * @param tx_buffer Send buffer, NULL to use SLIP_MAX_BUFFER on stack.
+ * @param tx_size   Send buffer size, the max encoded frame length of `slip_send_frame()`.
+ * 
+ * @return int
+ * @retval 0        Success.
+ * @retval -1       Error.
+*/
+int slip_init_with_buffer(struct slip *handler, struct slip_config *config,
+                          uint8_t *rx_pool, uint32_t rx_size,
+                          uint8_t *tx_buffer, uint16_t tx_size);
+
 /**
  * @brief Reset slip state.
  * 
@@ -64,6 +225,104 @@ int slip_init(struct slip *handler, struct slip_config *config);
 */
 void slip_reset(struct slip *handler);
 
+/**
+ * @brief Receive from a lock-free ring buffer filled by another thread (or ISR).
+ * 
+ * With a rx ring set, `recv()` in `slip_config` is not used by the receive functions,
+ * the producer puts received bytes into the ring and the decoder consumes them.
+ * 
+ * @param handler   Slip handler.
+ * @param ring      Single producer single consumer ring buffer, NULL to use `recv()`.
+ * 
+ * @return void
+*/
+void slip_set_rx_ring(struct slip *handler, struct spsc_ringbuffer *ring);
+
+/**
+ * @brief Set frame pool used by `slip_receive_frame_pooled()`.
+ * 
+ * @param handler   Slip handler.
+ * @param pool      Frame pool, see slip_pool.h.
+ * 
+ * @return void
+*/
+void slip_set_frame_pool(struct slip *handler, struct slip_pool *pool);
+
+/**
+ * @brief Use a transport instead of `send()`/`recv()` in `slip_config`.
+ * 
+ * Received bytes are read straight into the whole free space of the receive
+ * ring buffer. Frames are sent with one `writev()` per frame where possible:
+ * long runs of plain payload bytes are referenced in place, only END, escape
+ * sequences and short runs are copied into the send buffer, and nothing is truncated.
+ * 
+ * @param handler   Slip handler.
+ * @param transport Transport, NULL to use `slip_config` again.
+ * 
+ * @return void
+*/
+void slip_set_transport(struct slip *handler, const struct slip_transport *transport);
+
+/**
+ * @brief Take a snapshot of the link statistics.
+ * 
+ * Counters are plain integers updated by the sending and receiving threads,
+ * take the snapshot from one of them or while the link is idle.
+ * 
+ * @param handler   Slip handler.
+ * @param stats     Snapshot.
+ * 
+ * @return void
+*/
+void slip_get_stats(const struct slip *handler, struct slip_stats *stats);
+
+/**
+ * @brief Clear the link statistics.
+ * 
+ * @param handler   Slip handler.
+ * 
+ * @return void
+*/
+void slip_reset_stats(struct slip *handler);
+
+/**
+ * @brief Set frame buffer used by `slip_input()` and `slip_poll()`.
+ * 
+ * @param handler   Slip handler.
+ * @param buffer    Frame buffer, frames longer than it are dropped.
+ * @param size      Frame buffer size.
+ * 
+ * @return void
+*/
+void slip_set_frame_buffer(struct slip *handler, uint8_t *buffer, size_t size);
+
+/**
+ * @brief Decode received data and call `on_frame()` in `slip_config` for each complete frame.
+ * 
+ * Callback-driven receive, e.g. called from an uart ISR or an I/O callback with
+ * whatever bytes are at hand. Frames are handed over from the frame buffer as soon
+ * as their END arrives, the rest bytes are kept in the decoder for the next call.
+ * Do not mix it with the `slip_receive_*()` functions on the same handler.
+ * 
+ * @param handler   Slip handler, with frame buffer set.
+ * @param data      Received data.
+ * @param length    Received data length.
+ * 
+ * @return int      Count of frames handed to `on_frame()`, oversized frames are dropped.
+*/
+int slip_input(struct slip *handler, const uint8_t *data, size_t length);
+
+/**
+ * @brief Receive once and call `on_frame()` for each complete frame, see `slip_input()`.
+ * 
+ * Data comes from the rx ring, the transport or `recv()`, whichever is set.
+ * 
+ * @param handler   Slip handler, with frame buffer set.
+ * 
+ * @return int      Count of frames handed to `on_frame()`, -1 if the transport is closed or failed.
+*/
+int slip_poll(struct slip *handler);
+
 /**
  * @brief Send a frame, finally use `send()` function in `slip_config`.
  * 
@@ -75,10 +334,45 @@ void slip_reset(struct slip *handler);
  * @retval 0        Send success.
  * @retval -1       Send failed.
  * 
- * @note If the length larger than SLIP_MAX_BUFFER, send data will be truncated.
+ * @note If the encoded frame is larger than the send buffer (SLIP_MAX_BUFFER by default),
+ *       send data will be truncated, use `slip_send_framev()` to send long frames.
+ *       With `fcs` set such a frame is not sent and -1 is returned, the receiver
+ *       could not tell a truncated frame from a good one.
 */
 int slip_send_frame(struct slip *handler, uint8_t *buffer, uint16_t length);
 
+/**
+ * @brief Send a frame gathered from several segments, finally use `send()` function in `slip_config`.
+ * 
+ * The segments are encoded as one frame and sent in chunks of `chunk_size`
+ * in `slip_config`, so frames of any length are sent without truncation.
+ * 
+ * @param handler   Slip handler.
+ * @param iov       Payload segments.
+ * @param iovcnt    Payload segments count.
+ * 
+ * @return int
+ * @retval 0        Send success.
+ * @retval -1       Send failed.
+*/
+int slip_send_framev(struct slip *handler, const struct slip_iovec *iov, int iovcnt);
+
+/**
+ * @brief Encode data without the END delimiters, as much as `dst` can hold.
+ * 
+ * Runs of plain bytes are found with `slip_scan()` and copied in bulk, an
+ * escape sequence is never split.
+ * 
+ * @param dst       Buffer to store encoded data.
+ * @param dst_len   Buffer length.
+ * @param src       Data to be encoded.
+ * @param src_len   Data length.
+ * @param src_used  Encoded data length point.
+ * 
+ * @return size_t   Length written to `dst`.
+*/
+size_t slip_encode(uint8_t *dst, size_t dst_len, const uint8_t *src, size_t src_len, size_t *src_used);
+
 /**
  * @brief Receive a slip frame, finally use `recv()` function in `slip_config`.
  * 
@@ -90,9 +384,126 @@ int slip_send_frame(struct slip *handler, uint8_t *buffer, uint16_t length);
  * @return int
  * @retval  0       Receive success.       
  * @retval  -1      Buffer is not enough.
+ * @retval  -3      Transport is closed (end of stream) or failed, or `recv()` failed.
 */
 int slip_receive_frame(struct slip *handler, uint8_t *buffer, uint16_t length, uint16_t *recv_length);
 
+/**
+ * @brief Receive a slip frame like `slip_receive_frame()`, give up after `timeout_ms`.
+ * 
+ * While nothing is received the call sleeps in the `wait()` hook of the transport
+ * or `slip_config`, without a hook it polls until the timeout. The timeout holds
+ * even if bytes keep arriving without completing a frame. Bytes of an incomplete
+ * frame are already decoded into `buffer`, the next call completes the frame if it
+ * is given the same `buffer`, otherwise the frame is dropped (counted as oversize).
+ * 
+ * @param handler   Slip handler.
+ * @param buffer    Buffer to store data.
+ * @param length    Buffer length.
+ * @param recv_length   Receive data length point.
+ * @param timeout_ms    Max time to wait for the frame in milliseconds, -1 to wait forever.
+ * 
+ * @return int
+ * @retval  0       Receive success.
+ * @retval  -1      Buffer is not enough.
+ * @retval  -2      Timeout.
+ * @retval  -3      Transport is closed or failed, `recv()` or the `wait()` hook failed.
+*/
+int slip_receive_frame_timeout(struct slip *handler, uint8_t *buffer, uint16_t length, uint16_t *recv_length,
+                               int timeout_ms);
+
+/**
+ * @brief Receive all available slip frames, finally use `recv()` function in `slip_config`.
+ * 
+ * Block until a frame is received like `slip_receive_frame()`, then go on decoding
+ * the received bytes and return every complete frame in them.
+ * 
+ * @param handler       Slip handler.
+ * @param buffer        Buffer to store frames one behind another.
+ * @param length        Buffer length.
+ * @param frames        Received frames location in `buffer`.
+ * @param max_frames    Max count of `frames`.
+ * 
+ * @return int
+ * @retval  >0      Received frames count.
+ * @retval  -1      Buffer is not enough.
+ * @retval  -3      Transport is closed or failed, see `slip_receive_frame()`.
+*/
+int slip_receive_frames(struct slip *handler, uint8_t *buffer, size_t length, struct slip_frame *frames, int max_frames);
+
+/**
+ * @brief Receive a slip frame straight into a block of the frame pool.
+ * 
+ * The block is handed to the caller, release it with `slip_pool_release()`
+ * when done, possibly from another thread.
+ * 
+ * @param handler   Slip handler.
+ * @param frame     Received frame (pool block) point.
+ * @param recv_length   Receive data length point.
+ * 
+ * @return int
+ * @retval  0       Receive success.
+ * @retval  -1      Block is not enough, the frame is dropped.
+ * @retval  -2      Pool is empty, nothing is received.
+ * @retval  -3      Transport is closed or failed, see `slip_receive_frame()`.
+*/
+int slip_receive_frame_pooled(struct slip *handler, uint8_t **frame, uint16_t *recv_length);
+
+/**
+ * @brief Init a slip decoder, the statistics are cleared.
+ * 
+ * @param decoder   Slip decoder.
+ * @param buffer    Buffer to store the decoded frame.
+ * @param size      Buffer size.
+ * 
+ * @return void
+*/
+void slip_decoder_init(struct slip_decoder *decoder, uint8_t *buffer, size_t size);
+
+/**
+ * @brief Reset slip decoder state, the current frame is dropped and the statistics are kept.
+ * 
+ * @param decoder   Slip decoder.
+ * 
+ * @return void
+*/
+void slip_decoder_reset(struct slip_decoder *decoder);
+
+/**
+ * @brief Feed received bytes to the decoder, never blocks.
+ * 
+ * Decoding stops right after a frame is completed, so call it again with the
+ * remaining bytes until all of them are consumed to get every frame.
+ * 
+ * @param decoder   Slip decoder.
+ * @param data      Received bytes.
+ * @param length    Received bytes length.
+ * @param consumed  Consumed bytes length point.
+ * 
+ * @return int
+ * @retval  1       A frame is ready, see `decoder->buffer` and `decoder->length`.
+ * @retval  0       All bytes consumed, need more bytes.
+ * @retval  -1      Buffer is not enough, the frame is dropped.
+*/
+int slip_decoder_feed(struct slip_decoder *decoder, const uint8_t *data, size_t length, size_t *consumed);
+
+
+/**
+ * @brief Decode frames in place, a decoded frame is never longer than its encoded form.
+ * 
+ * The decoded frames overwrite the front of `buffer`, no extra buffer or copy is needed.
+ * Bytes from `consumed` on belong to an incomplete frame, keep them in front of the
+ * next received bytes.
+ * 
+ * @param buffer        Received bytes, overwritten by decoded frames.
+ * @param length        Received bytes length.
+ * @param frames        Decoded frames location in `buffer`.
+ * @param max_frames    Max count of `frames`.
+ * @param consumed      Consumed bytes length point.
+ * 
+ * @return int          Decoded frames count.
+*/
+int slip_decode_inplace(uint8_t *buffer, size_t length, struct slip_frame *frames, int max_frames, size_t *consumed);
 
 #if defined __cplusplus
 }
@@ -0,0 +1,175 @@
+#ifndef SLIP_HPP
+#define SLIP_HPP
+
+/*
+ * Header-only C++17 wrapper of the slip.c core. The transport is a template
+ * parameter, its calls are resolved at compile time and inline into the send and
+ * receive loops. Buffer sizes are template parameters, no heap allocation and no
+ * virtual dispatch is involved. The namespace is not `slip`, that is the C handler.
+ */
+
+#include "slip.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+#if __cplusplus >= 202002L && __has_include(<span>)
+#include <span>
+#endif
+
+namespace slip_cpp {
+
+#if defined __cpp_lib_span
+template <class T>
+using span = std::span<T>;
+#else
+/* Subset of std::span for C++17, a pointer and a length. */
+template <class T>
+class span {
+public:
+    constexpr span() noexcept = default;
+    constexpr span(T *data, std::size_t size) noexcept : data_(data), size_(size) {}
+    template <std::size_t N>
+    constexpr span(T (&array)[N]) noexcept : data_(array), size_(N) {}
+    /* Any contiguous container: std::array, std::vector, span<U> ... */
+    template <class C, class = std::enable_if_t<
+        std::is_convertible_v<decltype(std::declval<C &>().data()), T *>
+        && !std::is_array_v<std::remove_reference_t<C>>>>
+    constexpr span(C &&container) noexcept : data_(container.data()), size_(container.size()) {}
+
+    constexpr T *data() const noexcept { return data_; }
+    constexpr std::size_t size() const noexcept { return size_; }
+    constexpr bool empty() const noexcept { return size_ == 0; }
+    constexpr T &operator[](std::size_t i) const noexcept { return data_[i]; }
+    constexpr T *begin() const noexcept { return data_; }
+    constexpr T *end() const noexcept { return data_ + size_; }
+
+private:
+    T *data_ = nullptr;
+    std::size_t size_ = 0;
+};
+#endif
+
+namespace detail {
+
+template <class T, class = void>
+struct is_transport : std::false_type {};
+
+template <class T>
+struct is_transport<T, std::void_t<
+    decltype(std::declval<T &>().write(std::declval<const std::uint8_t *>(), std::size_t{})),
+    decltype(std::declval<T &>().read(std::declval<std::uint8_t *>(), std::size_t{}))>>
+    : std::is_convertible<decltype(std::declval<T &>().read(std::declval<std::uint8_t *>(), std::size_t{})),
+                          std::size_t> {};
+
+} // namespace detail
+
+/**
+ * A SLIP link over `Transport`, which provides:
+ *
+ *   void write(const std::uint8_t *data, std::size_t length);   // Write all bytes.
+ *   std::size_t read(std::uint8_t *buffer, std::size_t size);   // 0 if nothing to read now.
+ *
+ * @tparam Transport    Transport, stored by value (use a pointer-like wrapper to share one).
+ * @tparam MaxFrame     Max decoded frame length, larger frames are not sent or are dropped.
+ * @tparam ReadSize     Bytes asked from `Transport::read()` at once.
+ */
+template <class Transport, std::size_t MaxFrame = SLIP_MAX_BUFFER, std::size_t ReadSize = 256>
+class Link {
+    static_assert(detail::is_transport<Transport>::value,
+                  "Transport needs write(const uint8_t *, size_t) and size_t read(uint8_t *, size_t)");
+    static_assert(MaxFrame > 0 && ReadSize > 0, "buffer sizes must not be 0");
+
+public:
+    static constexpr std::size_t max_frame = MaxFrame;
+    /* Every byte escaped, and the two SLIP_END. */
+    static constexpr std::size_t tx_size = 2 * MaxFrame + 2;
+    static constexpr std::size_t read_size = ReadSize;
+
+    template <class... Args>
+    explicit Link(Args &&...args) : transport_(std::forward<Args>(args)...)
+    {
+        slip_decoder_init(&decoder_, rx_.data(), rx_.size());
+    }
+
+    // The decoder points into the object.
+    Link(const Link &) = delete;
+    Link &operator=(const Link &) = delete;
+
+    /**
+     * @brief Encode and write a frame.
+     *
+     * @return int
+     * @retval 0        Success.
+     * @retval -1       Frame longer than `MaxFrame`, nothing is written.
+    */
+    int send(span<const std::uint8_t> frame)
+    {
+        if (frame.size() > MaxFrame)
+            return -1;
+
+        std::size_t used;
+        std::size_t length = 1 + slip_encode(&tx_[1], tx_size - 2, frame.data(), frame.size(), &used);
+        tx_[0] = SLIP_END;
+        tx_[length++] = SLIP_END;
+        transport_.write(tx_.data(), length);
+
+        tx_stats_.frames++;
+        tx_stats_.bytes   += length;
+        tx_stats_.payload += frame.size();
+        tx_stats_.escapes += length - 2 - frame.size();
+        return 0;
+    }
+
+    /**
+     * @brief Read until a frame is decoded and copy it to `frame`.
+     *
+     * Bytes behind the frame are kept for the next call.
+     *
+     * @return long     Frame length.
+     * @retval -1       `Transport::read()` has nothing, call again later.
+     * @retval -2       Frame longer than `frame`, it is dropped.
+    */
+    long receive(span<std::uint8_t> frame)
+    {
+        for (;;) {
+            if (in_pos_ == in_length_) {
+                in_length_ = transport_.read(in_.data(), in_.size());
+                in_pos_ = 0;
+                if (in_length_ == 0)
+                    return -1;
+            }
+
+            std::size_t used;
+            int ret = slip_decoder_feed(&decoder_, &in_[in_pos_], in_length_ - in_pos_, &used);
+            in_pos_ += used;
+            if (ret > 0) {
+                if (decoder_.length > frame.size())
+                    return -2;
+                std::memcpy(frame.data(), rx_.data(), decoder_.length);
+                return static_cast<long>(decoder_.length);
+            }
+        }
+    }
+
+    const struct slip_rx_stats &rx_stats() const noexcept { return decoder_.stats; }
+    const struct slip_tx_stats &tx_stats() const noexcept { return tx_stats_; }
+    Transport &transport() noexcept { return transport_; }
+    const Transport &transport() const noexcept { return transport_; }
+
+private:
+    Transport transport_;
+    struct slip_decoder decoder_;
+    struct slip_tx_stats tx_stats_ = {};
+    std::size_t in_pos_ = 0;
+    std::size_t in_length_ = 0;
+    std::array<std::uint8_t, MaxFrame> rx_;
+    std::array<std::uint8_t, ReadSize> in_;
+    std::array<std::uint8_t, tx_size> tx_;
+};
+
+} // namespace slip_cpp
+
+#endif /* SLIP_HPP */
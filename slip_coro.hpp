@@ -0,0 +1,382 @@
+#ifndef SLIP_CORO_HPP
+#define SLIP_CORO_HPP
+
+/*
+ * C++20 coroutine API, Linux only: `co_await link.receive()` and
+ * `co_await link.send(frame)` over a non-blocking fd (serial port, pty, socket).
+ * A coroutine waiting for input or for room to write is suspended in a small
+ * epoll executor, `Executor::run()` threads resume it, so many links run as
+ * coroutines on a few threads.
+ */
+
+#include "slip.hpp"
+#include <atomic>
+#include <cerrno>
+#include <coroutine>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+
+namespace slip_cpp {
+
+/* Fire-and-forget coroutine, it starts at once and frees itself at the end. */
+struct Task {
+    struct promise_type {
+        Task get_return_object() noexcept { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept { std::terminate(); }
+    };
+};
+
+/* A suspended operation, `poll` retries it on an executor thread, true when done. */
+struct Waiter {
+    bool (*poll)(Waiter *waiter);
+    std::coroutine_handle<> handle;
+};
+
+/* Epoll registration of an fd, one reader and one writer may wait on it. */
+struct Watch {
+    int fd = -1;
+    bool added = false;
+    Waiter *reader = nullptr;
+    Waiter *writer = nullptr;
+    std::mutex lock;
+};
+
+class Executor {
+public:
+    Executor()
+        : epfd_(epoll_create1(EPOLL_CLOEXEC)), wakefd_(eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK))
+    {
+        struct epoll_event event = {};
+        event.events = EPOLLIN;
+        event.data.ptr = nullptr;
+        if (epfd_ >= 0 && wakefd_ >= 0)
+            epoll_ctl(epfd_, EPOLL_CTL_ADD, wakefd_, &event);
+    }
+
+    ~Executor()
+    {
+        if (epfd_ >= 0)
+            close(epfd_);
+        if (wakefd_ >= 0)
+            close(wakefd_);
+    }
+
+    Executor(const Executor &) = delete;
+    Executor &operator=(const Executor &) = delete;
+
+    bool valid() const noexcept { return epfd_ >= 0 && wakefd_ >= 0; }
+
+    /**
+     * @brief Resume ready coroutines until `stop()`, call it from as many threads as wanted.
+    */
+    void run()
+    {
+        struct epoll_event events[64];
+
+        while (!stopping_.load(std::memory_order_acquire)) {
+            int count = epoll_wait(epfd_, events, 64, -1);
+            for (int i = 0; i < count; i++) {
+                if (events[i].data.ptr == nullptr)
+                    wakeup();
+                else
+                    ready(*static_cast<Watch *>(events[i].data.ptr), events[i].events);
+            }
+        }
+    }
+
+    /**
+     * @brief Make every `run()` return, suspended coroutines stay suspended.
+    */
+    void stop()
+    {
+        stopping_.store(true, std::memory_order_release);
+        signal();
+    }
+
+    /* `co_await executor.schedule()` continues on a `run()` thread. */
+    auto schedule()
+    {
+        struct Awaiter {
+            Executor &executor;
+            bool await_ready() const noexcept { return false; }
+            void await_suspend(std::coroutine_handle<> handle)
+            {
+                {
+                    std::lock_guard<std::mutex> guard(executor.queue_lock_);
+                    executor.queue_.push_back(handle);
+                }
+                executor.signal();
+            }
+            void await_resume() const noexcept {}
+        };
+        return Awaiter{ *this };
+    }
+
+    /* Suspend `waiter` until `watch.fd` is readable (`writable` false) or writable. */
+    void wait(Watch &watch, Waiter *waiter, bool writable)
+    {
+        std::lock_guard<std::mutex> guard(watch.lock);
+        (writable ? watch.writer : watch.reader) = waiter;
+        arm(watch);
+    }
+
+    /* Remove the fd, nothing may wait on it any more. */
+    void forget(Watch &watch)
+    {
+        std::lock_guard<std::mutex> guard(watch.lock);
+        if (watch.added)
+            epoll_ctl(epfd_, EPOLL_CTL_DEL, watch.fd, nullptr);
+        watch.added = false;
+    }
+
+private:
+    // Level triggered and one-shot: an event goes to one thread, re-armed while someone waits.
+    void arm(Watch &watch)
+    {
+        struct epoll_event event = {};
+        event.events = EPOLLONESHOT | (watch.reader ? uint32_t(EPOLLIN) : 0) | (watch.writer ? uint32_t(EPOLLOUT) : 0);
+        event.data.ptr = &watch;
+        epoll_ctl(epfd_, watch.added ? EPOLL_CTL_MOD : EPOLL_CTL_ADD, watch.fd, &event);
+        watch.added = true;
+    }
+
+    void ready(Watch &watch, uint32_t events)
+    {
+        Waiter *done[2];
+        int count = 0;
+        {
+            std::lock_guard<std::mutex> guard(watch.lock);
+            if (watch.reader && (events & (EPOLLIN | EPOLLERR | EPOLLHUP)) && watch.reader->poll(watch.reader)) {
+                done[count++] = watch.reader;
+                watch.reader = nullptr;
+            }
+            if (watch.writer && (events & (EPOLLOUT | EPOLLERR | EPOLLHUP)) && watch.writer->poll(watch.writer)) {
+                done[count++] = watch.writer;
+                watch.writer = nullptr;
+            }
+            if (watch.reader || watch.writer)
+                arm(watch);
+        }
+        // Resumed out of the lock, the coroutine may wait on the fd again.
+        for (int i = 0; i < count; i++)
+            done[i]->handle.resume();
+    }
+
+    void signal()
+    {
+        uint64_t one = 1;
+        ssize_t ret = write(wakefd_, &one, sizeof(one));
+        (void)ret;
+    }
+
+    void wakeup()
+    {
+        // Left signaled while stopping, so every run() thread sees it.
+        if (stopping_.load(std::memory_order_acquire))
+            return;
+        uint64_t value;
+        ssize_t ret = read(wakefd_, &value, sizeof(value));
+        (void)ret;
+
+        std::vector<std::coroutine_handle<>> handles;
+        {
+            std::lock_guard<std::mutex> guard(queue_lock_);
+            handles.swap(queue_);
+        }
+        for (auto handle : handles)
+            handle.resume();
+    }
+
+    int epfd_;
+    int wakefd_;
+    std::atomic<bool> stopping_{ false };
+    std::mutex queue_lock_;
+    std::vector<std::coroutine_handle<>> queue_;
+};
+
+/**
+ * A SLIP link over a non-blocking fd driven by an `Executor`. One coroutine may
+ * receive and another one send at the same time. Destroy it when none is suspended.
+ *
+ * @tparam MaxFrame     Max decoded frame length, longer frames are dropped or not sent.
+ * @tparam ReadSize     Bytes read from the fd at once.
+ */
+template <std::size_t MaxFrame = SLIP_MAX_BUFFER, std::size_t ReadSize = 4096>
+class AsyncLink {
+public:
+    static constexpr std::size_t max_frame = MaxFrame;
+    static constexpr std::size_t tx_size = 2 * MaxFrame + 2;
+
+    /* `fd` is switched to non-blocking mode, it is not closed by the link. */
+    AsyncLink(Executor &executor, int fd) : executor_(executor)
+    {
+        watch_.fd = fd;
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+        slip_decoder_init(&decoder_, rx_.data(), rx_.size());
+    }
+
+    ~AsyncLink() { executor_.forget(watch_); }
+
+    AsyncLink(const AsyncLink &) = delete;
+    AsyncLink &operator=(const AsyncLink &) = delete;
+
+    /**
+     * @brief `co_await link.receive()` gives the next frame, std::nullopt once
+     *        the fd reaches end of file or fails. The frame is valid until the next receive.
+    */
+    auto receive()
+    {
+        struct Awaiter : Waiter {
+            AsyncLink &link;
+
+            explicit Awaiter(AsyncLink &link) : Waiter{ &Awaiter::retry, {} }, link(link) {}
+            static bool retry(Waiter *waiter) { return static_cast<Awaiter *>(waiter)->link.poll_receive(); }
+
+            bool await_ready() { return link.poll_receive(); }
+            void await_suspend(std::coroutine_handle<> handle)
+            {
+                this->handle = handle;
+                link.executor_.wait(link.watch_, this, false);
+            }
+            std::optional<span<const std::uint8_t>> await_resume() { return link.take_frame(); }
+        };
+        return Awaiter{ *this };
+    }
+
+    /**
+     * @brief `co_await link.send(frame)` encodes and writes a frame.
+     *
+     * @return int
+     * @retval 0        Success.
+     * @retval -1       Frame longer than `MaxFrame`, or the fd failed (see errno).
+    */
+    auto send(span<const std::uint8_t> frame)
+    {
+        struct Awaiter : Waiter {
+            AsyncLink &link;
+            int result = 0;
+
+            Awaiter(AsyncLink &link, span<const std::uint8_t> frame) : Waiter{ &Awaiter::retry, {} }, link(link)
+            {
+                result = link.encode(frame);
+            }
+            static bool retry(Waiter *waiter)
+            {
+                auto *self = static_cast<Awaiter *>(waiter);
+                return self->link.poll_send(self->result);
+            }
+
+            bool await_ready() { return result != 0 || link.poll_send(result); }
+            void await_suspend(std::coroutine_handle<> handle)
+            {
+                this->handle = handle;
+                link.executor_.wait(link.watch_, this, true);
+            }
+            int await_resume() const noexcept { return result; }
+        };
+        return Awaiter{ *this, frame };
+    }
+
+    const struct slip_rx_stats &rx_stats() const noexcept { return decoder_.stats; }
+    const struct slip_tx_stats &tx_stats() const noexcept { return tx_stats_; }
+    int fd() const noexcept { return watch_.fd; }
+
+private:
+    // Decode buffered bytes and read more, false if the fd has nothing for now.
+    bool poll_receive()
+    {
+        for (;;) {
+            while (in_pos_ < in_length_) {
+                std::size_t used;
+                int ret = slip_decoder_feed(&decoder_, &in_[in_pos_], in_length_ - in_pos_, &used);
+                in_pos_ += used;
+                if (ret > 0) {
+                    frame_ready_ = true;
+                    return true;
+                }
+            }
+            ssize_t n = read(watch_.fd, in_.data(), in_.size());
+            if (n > 0) {
+                in_pos_ = 0;
+                in_length_ = static_cast<std::size_t>(n);
+            } else if (n < 0 && errno == EINTR) {
+                continue;
+            } else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                return false;
+            } else {
+                return true;        // End of file or error.
+            }
+        }
+    }
+
+    std::optional<span<const std::uint8_t>> take_frame()
+    {
+        if (!frame_ready_)
+            return std::nullopt;
+        frame_ready_ = false;
+        return span<const std::uint8_t>(rx_.data(), decoder_.length);
+    }
+
+    int encode(span<const std::uint8_t> frame)
+    {
+        if (frame.size() > MaxFrame)
+            return -1;
+
+        std::size_t used;
+        tx_length_ = 1 + slip_encode(&tx_[1], tx_size - 2, frame.data(), frame.size(), &used);
+        tx_[0] = SLIP_END;
+        tx_[tx_length_++] = SLIP_END;
+        tx_pos_ = 0;
+
+        tx_stats_.frames++;
+        tx_stats_.bytes   += tx_length_;
+        tx_stats_.payload += frame.size();
+        tx_stats_.escapes += tx_length_ - 2 - frame.size();
+        return 0;
+    }
+
+    // Write the rest of the encoded frame, false if the fd is full.
+    bool poll_send(int &result)
+    {
+        while (tx_pos_ < tx_length_) {
+            ssize_t n = write(watch_.fd, &tx_[tx_pos_], tx_length_ - tx_pos_);
+            if (n > 0) {
+                tx_pos_ += static_cast<std::size_t>(n);
+            } else if (n < 0 && errno == EINTR) {
+                continue;
+            } else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                return false;
+            } else {
+                result = -1;
+                return true;
+            }
+        }
+        return true;
+    }
+
+    Executor &executor_;
+    Watch watch_;
+    struct slip_decoder decoder_;
+    struct slip_tx_stats tx_stats_ = {};
+    bool frame_ready_ = false;
+    std::size_t in_pos_ = 0;
+    std::size_t in_length_ = 0;
+    std::size_t tx_pos_ = 0;
+    std::size_t tx_length_ = 0;
+    std::array<std::uint8_t, MaxFrame> rx_;
+    std::array<std::uint8_t, ReadSize> in_;
+    std::array<std::uint8_t, tx_size> tx_;
+};
+
+} // namespace slip_cpp
+
+#endif /* SLIP_CORO_HPP */
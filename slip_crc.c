@@ -0,0 +1,106 @@
+#include "slip_crc.h"
+#include "slip_crc_table.h"
+#include <stdatomic.h>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define SLIP_CRC_X86
+#include <immintrin.h>
+#endif
+
+static uint32_t slip_crc_table_update(uint32_t crc, const uint8_t *data, size_t length)
+{
+    const uint32_t (*t)[256] = slip_crc_table;
+
+    for (; length >= 8; data += 8, length -= 8) {
+        uint32_t lo = crc ^ ((uint32_t)data[0] | (uint32_t)data[1] << 8 | (uint32_t)data[2] << 16 | (uint32_t)data[3] << 24);
+        uint32_t hi = (uint32_t)data[4] | (uint32_t)data[5] << 8 | (uint32_t)data[6] << 16 | (uint32_t)data[7] << 24;
+        crc = t[7][lo & 0xFF] ^ t[6][(lo >> 8) & 0xFF] ^ t[5][(lo >> 16) & 0xFF] ^ t[4][lo >> 24]
+            ^ t[3][hi & 0xFF] ^ t[2][(hi >> 8) & 0xFF] ^ t[1][(hi >> 16) & 0xFF] ^ t[0][hi >> 24];
+    }
+    while (length--)
+        crc = (crc >> 8) ^ t[0][(crc ^ *data++) & 0xFF];
+    return crc;
+}
+
+#ifdef SLIP_CRC_X86
+__attribute__((target("sse4.2")))
+static uint32_t slip_crc_sse42_update(uint32_t crc, const uint8_t *data, size_t length)
+{
+#ifdef __x86_64__
+    uint64_t crc64 = crc;
+    for (; length >= 8; data += 8, length -= 8) {
+        uint64_t v;
+        __builtin_memcpy(&v, data, sizeof(v));
+        crc64 = _mm_crc32_u64(crc64, v);
+    }
+    crc = (uint32_t)crc64;
+#endif
+    for (; length >= 4; data += 4, length -= 4) {
+        uint32_t v;
+        __builtin_memcpy(&v, data, sizeof(v));
+        crc = _mm_crc32_u32(crc, v);
+    }
+    while (length--)
+        crc = _mm_crc32_u8(crc, *data++);
+    return crc;
+}
+#endif
+
+typedef uint32_t (*slip_crc_fn)(uint32_t, const uint8_t *, size_t);
+
+static uint32_t slip_crc_resolve(uint32_t crc, const uint8_t *data, size_t length);
+
+/* Resolved by the first call, unless `slip_crc32c_select()` came first. */
+static _Atomic(slip_crc_fn) slip_crc_func = slip_crc_resolve;
+
+static slip_crc_fn slip_crc_auto(void)
+{
+#ifdef SLIP_CRC_X86
+    if (__builtin_cpu_supports("sse4.2"))
+        return slip_crc_sse42_update;
+#endif
+    return slip_crc_table_update;
+}
+
+static uint32_t slip_crc_resolve(uint32_t crc, const uint8_t *data, size_t length)
+{
+    slip_crc_fn expected = slip_crc_resolve;
+
+    atomic_compare_exchange_strong(&slip_crc_func, &expected, slip_crc_auto());
+    return atomic_load_explicit(&slip_crc_func, memory_order_acquire)(crc, data, length);
+}
+
+uint32_t slip_crc32c_update(uint32_t crc, const uint8_t *data, size_t length)
+{
+    return atomic_load_explicit(&slip_crc_func, memory_order_acquire)(crc, data, length);
+}
+
+uint32_t slip_crc32c(const uint8_t *data, size_t length)
+{
+    return ~slip_crc32c_update(SLIP_CRC32C_INIT, data, length);
+}
+
+int slip_crc32c_select(SLIP_CRC_IMPL impl)
+{
+    slip_crc_fn func;
+
+    switch (impl) {
+    case SLIP_CRC_AUTO:
+        func = slip_crc_auto();
+        break;
+    case SLIP_CRC_TABLE:
+        func = slip_crc_table_update;
+        break;
+#ifdef SLIP_CRC_X86
+    case SLIP_CRC_SSE42:
+        if (!__builtin_cpu_supports("sse4.2"))
+            return -1;
+        func = slip_crc_sse42_update;
+        break;
+#endif
+    default:
+        return -1;
+    }
+    atomic_store_explicit(&slip_crc_func, func, memory_order_release);
+    return 0;
+}
@@ -0,0 +1,64 @@
+#ifndef SLIP_CRC_H
+#define SLIP_CRC_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#if defined __cplusplus
+extern "C" {
+#endif
+
+/* Frame check sequence: CRC-32C (Castagnoli) of the payload, little endian. */
+#define SLIP_FCS_SIZE           4
+
+/* Initial register value. */
+#define SLIP_CRC32C_INIT        0xFFFFFFFFu
+
+/* Register value after the payload and its FCS were fed, for a good frame. */
+#define SLIP_CRC32C_RESIDUE     0xB798B438u
+
+typedef enum {
+    SLIP_CRC_AUTO = 0,      /* Best implementation supported by the CPU. */
+    SLIP_CRC_TABLE,         /* Slicing-by-8. */
+    SLIP_CRC_SSE42,         /* SSE4.2 crc32 instruction. */
+} SLIP_CRC_IMPL;
+
+/**
+ * @brief Feed data to a CRC-32C register, no pre or post inversion.
+ * 
+ * Start with SLIP_CRC32C_INIT, the CRC is the inverted register.
+ * 
+ * @param crc       Register value.
+ * @param data      Data.
+ * @param length    Data length.
+ * 
+ * @return uint32_t New register value.
+*/
+uint32_t slip_crc32c_update(uint32_t crc, const uint8_t *data, size_t length);
+
+/**
+ * @brief CRC-32C of data.
+ * 
+ * @param data      Data.
+ * @param length    Data length.
+ * 
+ * @return uint32_t CRC, e.g. 0xE3069283 for "123456789".
+*/
+uint32_t slip_crc32c(const uint8_t *data, size_t length);
+
+/**
+ * @brief Select CRC implementation, the default is chosen at runtime.
+ * 
+ * @param impl      CRC implementation.
+ * 
+ * @return int
+ * @retval 0        Success.
+ * @retval -1       Not supported by this CPU or build.
+*/
+int slip_crc32c_select(SLIP_CRC_IMPL impl);
+
+#if defined __cplusplus
+}
+#endif
+
+#endif /* SLIP_CRC_H */
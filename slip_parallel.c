@@ -0,0 +1,241 @@
+#include "slip_parallel.h"
+#include <errno.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/*
+ * A chunk starts right behind a SLIP_END, so the decoder enters it in one of
+ * FRAME_START, FRAME_END or DECODING (frame just started, nothing decoded). It is
+ * decoded from FRAME_START before the state is known. Whatever the real state, the
+ * decoder is in FRAME_END behind the first SLIP_END that follows a byte other than
+ * SLIP_END, and from there on the result is the same. Only the leading SLIP_END run
+ * and the first frame differ, the stitch fixes them up knowing the real state.
+ */
+
+/* Decoded frame of a chunk, `end` is the stream offset behind its SLIP_END. */
+struct slip_parallel_frame {
+    size_t offset;
+    size_t length;
+    size_t end;
+};
+
+struct slip_parallel_chunk {
+    size_t begin;
+    size_t end;
+    size_t ends;                /* Leading SLIP_END count. */
+    int data;                   /* Has a byte other than SLIP_END. */
+    int synced;                 /* Has a SLIP_END behind that byte. */
+    size_t sync_end;            /* Behind that SLIP_END. */
+    SLIP_DECODER_STATE state;   /* Decoder state at the end of the chunk. */
+    struct slip_parallel_frame *frames;
+    size_t count;
+    size_t capacity;
+    int error;
+};
+
+struct slip_parallel_job {
+    const uint8_t *data;
+    uint8_t *out;
+    struct slip_parallel_chunk *chunks;
+    size_t count;
+    atomic_size_t next;
+};
+
+static void slip_parallel_decode(struct slip_parallel_job *job, struct slip_parallel_chunk *chunk, int first)
+{
+    const uint8_t *data = job->data;
+    struct slip_decoder decoder;
+    size_t rd = chunk->begin, wr = chunk->begin, used;
+
+    while (chunk->begin + chunk->ends < chunk->end && data[chunk->begin + chunk->ends] == SLIP_END)
+        chunk->ends++;
+    rd += chunk->ends;
+    chunk->data = rd < chunk->end;
+    const uint8_t *sync = chunk->data ? memchr(&data[rd], SLIP_END, chunk->end - rd) : NULL;
+    chunk->synced = sync != NULL;
+    chunk->sync_end = sync ? (size_t)(sync - data) + 1 : 0;
+
+    // Decoded bytes are never more than the encoded ones, the chunk's span of `out` is enough.
+    slip_decoder_init(&decoder, &job->out[wr], chunk->end - wr);
+    decoder.state = first ? SLIP_UNKNOWN_STATE : SLIP_FRAME_START_STATE;
+    rd = chunk->begin;
+    while (rd < chunk->end) {
+        int ret = slip_decoder_feed(&decoder, &data[rd], chunk->end - rd, &used);
+        rd += used;
+        if (ret > 0) {
+            if (chunk->count == chunk->capacity) {
+                size_t capacity = chunk->capacity ? chunk->capacity * 2 : 64;
+                void *frames = realloc(chunk->frames, capacity * sizeof(*chunk->frames));
+                if (frames == NULL) {
+                    chunk->error = 1;
+                    return;
+                }
+                chunk->frames = frames;
+                chunk->capacity = capacity;
+            }
+            chunk->frames[chunk->count].offset = wr;
+            chunk->frames[chunk->count].length = decoder.length;
+            chunk->frames[chunk->count].end = rd;
+            chunk->count++;
+            wr += decoder.length;
+            decoder.buffer = &job->out[wr];
+            decoder.size   = chunk->end - wr;
+        }
+    }
+    chunk->state = decoder.state;
+}
+
+static void *slip_parallel_thread(void *arg)
+{
+    struct slip_parallel_job *job = arg;
+    size_t i;
+
+    while ((i = atomic_fetch_add(&job->next, 1)) < job->count)
+        slip_parallel_decode(job, &job->chunks[i], i == 0);
+    return NULL;
+}
+
+/* Cut `data` into chunks of about `target` bytes, return the chunk count. */
+static size_t slip_parallel_cut(const uint8_t *data, size_t length, size_t target, struct slip_parallel_chunk *chunks)
+{
+    size_t count = 0, begin = 0;
+
+    while (begin < length) {
+        size_t end = length;
+        // Behind a SLIP_END which is not escaped, the decoder state is one of three.
+        for (size_t pos = begin + target; pos < length; pos++) {
+            const uint8_t *p = memchr(&data[pos], SLIP_END, length - pos);
+            if (p == NULL)
+                break;
+            pos = p - data;
+            if (data[pos - 1] != SLIP_ESC) {
+                end = pos + 1;
+                break;
+            }
+        }
+        chunks[count].begin = begin;
+        chunks[count].end = end;
+        count++;
+        begin = end;
+    }
+    return count;
+}
+
+long slip_decode_parallel(const uint8_t *data, size_t length, uint8_t *out,
+                          struct slip_frame *frames, size_t max_frames, size_t *consumed, int threads)
+{
+    SLIP_ASSERT(data || length == 0);
+    SLIP_ASSERT(out || length == 0);
+    SLIP_ASSERT(frames || max_frames == 0);
+    SLIP_ASSERT(consumed);
+
+    if (threads <= 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = cpus > 0 ? (int)cpus : 1;
+    }
+
+    size_t target = length / ((size_t)threads * SLIP_PARALLEL_CHUNKS);
+    if (target < SLIP_PARALLEL_MIN_CHUNK)
+        target = SLIP_PARALLEL_MIN_CHUNK;
+
+    struct slip_parallel_job job = { .data = data, .out = out };
+    pthread_t *tids = calloc(threads, sizeof(*tids));
+    job.chunks = calloc(length / target + 1, sizeof(*job.chunks));
+    if (tids == NULL || job.chunks == NULL) {
+        free(tids);
+        free(job.chunks);
+        errno = ENOMEM;
+        return -1;
+    }
+    job.count = slip_parallel_cut(data, length, target, job.chunks);
+    atomic_init(&job.next, 0);
+
+    // The caller is a worker too, fewer threads than asked only run slower.
+    int started = 0;
+    while (started + 1 < threads && (size_t)started + 1 < job.count
+           && pthread_create(&tids[started], NULL, slip_parallel_thread, &job) == 0)
+        started++;
+    slip_parallel_thread(&job);
+    for (int i = 0; i < started; i++)
+        pthread_join(tids[i], NULL);
+    free(tids);
+
+    // Stitch the chunks in order, knowing the real state at each cut.
+    SLIP_DECODER_STATE state = SLIP_UNKNOWN_STATE;
+    size_t count = 0;
+    long ret = 0;
+    *consumed = 0;
+    for (size_t k = 0; k < job.count; k++) {
+        struct slip_parallel_chunk *chunk = &job.chunks[k];
+        size_t empties = 0, skip = 0, first_end = 0;
+
+        if (chunk->error) {
+            errno = ENOMEM;
+            ret = -1;
+            break;
+        }
+        if (k > 0) {
+            // Replay the leading SLIP_END run, a frame started there is empty.
+            SLIP_DECODER_STATE after;
+            switch (state) {
+            case SLIP_FRAME_START_STATE:
+                after = SLIP_FRAME_START_STATE;
+                break;
+            case SLIP_DECODING_STATE:
+                empties = (chunk->ends + 1) / 2;
+                first_end = chunk->begin + 1;
+                after = (chunk->ends & 1) ? SLIP_FRAME_END_STATE : SLIP_DECODING_STATE;
+                break;
+            case SLIP_FRAME_END_STATE:
+                empties = chunk->ends / 2;
+                first_end = chunk->begin + 2;
+                after = (chunk->ends & 1) ? SLIP_DECODING_STATE : SLIP_FRAME_END_STATE;
+                break;
+            default:
+                SLIP_ASSERT(0);
+                after = state;
+                break;
+            }
+            // In FRAME_END the next byte is a framing error, the first frame is not decoded
+            // (unless a bad escape already dropped it).
+            if (chunk->count > 0 && chunk->frames[0].end == chunk->sync_end && after == SLIP_FRAME_END_STATE)
+                skip = 1;
+            if (!chunk->data)
+                chunk->state = after;
+            else if (!chunk->synced && after == SLIP_FRAME_END_STATE)
+                chunk->state = SLIP_ERROR_STATE;
+        }
+        state = chunk->state;
+
+        for (size_t i = 0; i < empties; i++) {
+            if (count == max_frames)
+                break;
+            frames[count].offset = chunk->begin;
+            frames[count].length = 0;
+            count++;
+            *consumed = first_end + 2 * i;
+        }
+        for (size_t i = skip; i < chunk->count; i++) {
+            if (count == max_frames)
+                break;
+            frames[count].offset = chunk->frames[i].offset;
+            frames[count].length = chunk->frames[i].length;
+            count++;
+            *consumed = chunk->frames[i].end;
+        }
+        if (count == max_frames)
+            break;
+    }
+
+    // No frame is pending, the rest bytes are garbage.
+    if (ret == 0 && count < max_frames && (state == SLIP_UNKNOWN_STATE || state == SLIP_ERROR_STATE))
+        *consumed = length;
+
+    for (size_t k = 0; k < job.count; k++)
+        free(job.chunks[k].frames);
+    free(job.chunks);
+    return ret == 0 ? (long)count : -1;
+}
@@ -0,0 +1,40 @@
+#ifndef SLIP_PARALLEL_H
+#define SLIP_PARALLEL_H
+
+#include "slip.h"
+
+#if defined __cplusplus
+extern "C" {
+#endif
+
+/* Chunks are not cut smaller than this, small buffers use fewer threads. */
+#define SLIP_PARALLEL_MIN_CHUNK     (64 * 1024)
+/* Chunks per thread, idle threads take the next chunk so uneven chunks balance out. */
+#define SLIP_PARALLEL_CHUNKS        4
+
+/**
+ * @brief Decode a large buffer of frames (e.g. a capture) on several threads.
+ *
+ * `data` is cut into chunks right behind SLIP_END bytes, the chunks are decoded in
+ * parallel and stitched in stream order. Frames, `consumed` and the return value are
+ * the ones of `slip_decode_inplace()` on the same bytes, but `data` is not modified and
+ * the frames are not packed: each one is somewhere in `out`.
+ *
+ * @param data          Encoded bytes.
+ * @param length        Encoded bytes length.
+ * @param out           Decoded bytes, at least `length` bytes.
+ * @param frames        Decoded frames location in `out`, in stream order.
+ * @param max_frames    Max count of `frames`.
+ * @param consumed      Consumed bytes length point.
+ * @param threads       Thread count, 0 for the count of online CPUs.
+ *
+ * @return long         Decoded frames count, -1 on error (see errno).
+*/
+long slip_decode_parallel(const uint8_t *data, size_t length, uint8_t *out,
+                          struct slip_frame *frames, size_t max_frames, size_t *consumed, int threads);
+
+#if defined __cplusplus
+}
+#endif
+
+#endif /* SLIP_PARALLEL_H */
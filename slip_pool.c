@@ -0,0 +1,64 @@
+#include "slip_pool.h"
+#include <assert.h>
+
+#define SLIP_POOL_ALIGN(size)   (((size) + 7) & ~(size_t)7)
+/* Each block starts with the index of next free block. */
+#define SLIP_POOL_HEADER        SLIP_POOL_ALIGN(sizeof(atomic_uint_least32_t))
+
+static atomic_uint_least32_t *slip_pool_next(struct slip_pool *pool, uint32_t index)
+{
+    return (atomic_uint_least32_t *)&pool->memory[(size_t)index * pool->stride];
+}
+
+int slip_pool_init(struct slip_pool *pool, uint8_t *memory, size_t memory_size, size_t block_size)
+{
+    assert(pool);
+    assert(memory);
+    assert(((uintptr_t)memory & 7) == 0);
+
+    pool->memory = memory;
+    pool->block_size = block_size;
+    pool->stride = SLIP_POOL_HEADER + SLIP_POOL_ALIGN(block_size);
+    pool->count = memory_size / pool->stride;
+
+    // Link all blocks, block 0 on top.
+    for (uint32_t i = 0; i < pool->count; i++)
+        atomic_init(slip_pool_next(pool, i), (i + 1 < pool->count) ? i + 2 : 0);
+    atomic_init(&pool->head, pool->count ? 1 : 0);
+
+    return pool->count;
+}
+
+uint8_t *slip_pool_acquire(struct slip_pool *pool)
+{
+    uint64_t head = atomic_load_explicit(&pool->head, memory_order_acquire);
+    uint64_t next;
+    uint32_t index;
+
+    do {
+        index = (uint32_t)head;
+        if (index == 0)
+            return NULL;
+        next = ((head >> 32) + 1) << 32
+             | atomic_load_explicit(slip_pool_next(pool, index - 1), memory_order_relaxed);
+    } while (!atomic_compare_exchange_weak_explicit(&pool->head, &head, next,
+                                                    memory_order_acquire, memory_order_acquire));
+
+    return &pool->memory[(size_t)(index - 1) * pool->stride + SLIP_POOL_HEADER];
+}
+
+void slip_pool_release(struct slip_pool *pool, uint8_t *block)
+{
+    assert(block >= pool->memory + SLIP_POOL_HEADER);
+
+    uint32_t index = (uint32_t)((size_t)(block - pool->memory) / pool->stride);
+    uint64_t head = atomic_load_explicit(&pool->head, memory_order_relaxed);
+    uint64_t next;
+
+    assert(index < pool->count);
+    do {
+        atomic_store_explicit(slip_pool_next(pool, index), (uint32_t)head, memory_order_relaxed);
+        next = ((head >> 32) + 1) << 32 | (index + 1);
+    } while (!atomic_compare_exchange_weak_explicit(&pool->head, &head, next,
+                                                    memory_order_release, memory_order_relaxed));
+}
@@ -0,0 +1,58 @@
+#ifndef SLIP_POOL_H
+#define SLIP_POOL_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdatomic.h>
+
+#if defined __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Fixed-size frame buffer pool.
+ *
+ * Blocks are carved out of caller supplied memory and kept in a lock-free
+ * free list, so a block can be acquired by the receive thread and released
+ * by any other thread. The list head carries a tag against ABA.
+ */
+struct slip_pool {
+    _Atomic uint64_t head;      /* tag << 32 | (index + 1), 0 index means empty */
+    uint8_t *memory;
+    size_t block_size;          /* Usable size of a block. */
+    size_t stride;              /* Block size with its header. */
+    uint32_t count;
+};
+
+/**
+ * @brief Init a frame pool.
+ * 
+ * @param pool          Frame pool.
+ * @param memory        Pool memory, 8 bytes aligned.
+ * @param memory_size   Pool memory size.
+ * @param block_size    Max frame length in a block.
+ * 
+ * @return int          Blocks count, 0 if the memory is not enough for a block.
+*/
+int slip_pool_init(struct slip_pool *pool, uint8_t *memory, size_t memory_size, size_t block_size);
+
+/**
+ * @brief Acquire a block, thread safe.
+ * 
+ * @return uint8_t*     Block, NULL if the pool is empty.
+*/
+uint8_t *slip_pool_acquire(struct slip_pool *pool);
+
+/**
+ * @brief Release a block got from the pool, thread safe.
+ * 
+ * @param pool      Frame pool.
+ * @param block     Block (received frame) to be released.
+*/
+void slip_pool_release(struct slip_pool *pool, uint8_t *block);
+
+#if defined __cplusplus
+}
+#endif
+
+#endif /* SLIP_POOL_H */
@@ -0,0 +1,162 @@
+#include "slip_posix.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/uio.h>
+#ifdef __linux__
+#include <sys/ioctl.h>
+#include <linux/serial.h>
+#endif
+
+#define SLIP_POSIX_IOV  16
+
+/* Wait until a fd is ready, 1 ready, 0 timeout and -1 error (or hang up with nothing to read). */
+static int slip_posix_poll(int fd, short events, int timeout_ms)
+{
+    struct pollfd pfd = { .fd = fd, .events = events };
+    int ret;
+
+    // A signal restarts the full timeout, fine for receive timeouts.
+    while ((ret = poll(&pfd, 1, timeout_ms)) < 0) {
+        if (errno != EINTR)
+            return -1;
+    }
+    if (ret == 0)
+        return 0;
+    // Bytes received before a hang up are still read.
+    if ((pfd.revents & (POLLERR | POLLNVAL)) || !(pfd.revents & events))
+        return -1;
+    return 1;
+}
+
+static int slip_posix_wait(void *ctx, int timeout_ms)
+{
+    struct slip_posix *posix = ctx;
+
+    return slip_posix_poll(posix->fd, POLLIN, timeout_ms);
+}
+
+static int slip_posix_writev(void *ctx, const struct slip_iovec *iov, int iovcnt)
+{
+    struct slip_posix *posix = ctx;
+    struct iovec vec[SLIP_POSIX_IOV];
+
+    while (iovcnt > 0) {
+        int n = iovcnt < SLIP_POSIX_IOV ? iovcnt : SLIP_POSIX_IOV;
+        for (int i = 0; i < n; i++) {
+            vec[i].iov_base = (void *)iov[i].base;
+            vec[i].iov_len  = iov[i].length;
+        }
+
+        // Write the batch, resume after partial writes.
+        int i = 0;
+        while (i < n) {
+            ssize_t size = writev(posix->fd, &vec[i], n - i);
+            if (size < 0) {
+                if (errno == EINTR)
+                    continue;
+                if ((errno == EAGAIN || errno == EWOULDBLOCK) && slip_posix_poll(posix->fd, POLLOUT, -1) > 0)
+                    continue;
+                return -1;
+            }
+            while (i < n && (size_t)size >= vec[i].iov_len)
+                size -= vec[i++].iov_len;
+            if (i < n) {
+                vec[i].iov_base = (uint8_t *)vec[i].iov_base + size;
+                vec[i].iov_len -= size;
+            }
+        }
+        iov    += n;
+        iovcnt -= n;
+    }
+    return 0;
+}
+
+static long slip_posix_read(void *ctx, uint8_t *buffer, size_t length)
+{
+    struct slip_posix *posix = ctx;
+
+    while (1) {
+        ssize_t size = read(posix->fd, buffer, length);
+        if (size >= 0)
+            return size;
+        if (errno == EINTR)
+            continue;
+        // The receive functions block, so do it for a non-blocking fd too.
+        if ((errno == EAGAIN || errno == EWOULDBLOCK) && slip_posix_poll(posix->fd, POLLIN, -1) > 0)
+            continue;
+        return -1;
+    }
+}
+
+void slip_posix_init(struct slip_posix *posix, int fd)
+{
+    SLIP_ASSERT(posix);
+
+    posix->fd = fd;
+    posix->transport.writev = slip_posix_writev;
+    posix->transport.read   = slip_posix_read;
+    posix->transport.ctx    = posix;
+    posix->transport.wait   = slip_posix_wait;
+}
+
+int slip_posix_set_raw(int fd, speed_t speed)
+{
+    struct termios tio;
+
+    if (tcgetattr(fd, &tio) < 0)
+        return -1;
+
+    tio.c_iflag &= ~(IGNBRK | BRKINT | PARMRK | ISTRIP | INLCR | IGNCR | ICRNL | IXON | IXOFF | IXANY);
+    tio.c_oflag &= ~OPOST;
+    tio.c_lflag &= ~(ECHO | ECHONL | ICANON | ISIG | IEXTEN);
+    tio.c_cflag &= ~(CSIZE | PARENB | CSTOPB);
+#ifdef CRTSCTS
+    tio.c_cflag &= ~CRTSCTS;
+#endif
+    tio.c_cflag |= CS8 | CREAD | CLOCAL;
+    tio.c_cc[VMIN]  = 1;
+    tio.c_cc[VTIME] = 0;
+    if (speed != 0 && (cfsetispeed(&tio, speed) < 0 || cfsetospeed(&tio, speed) < 0))
+        return -1;
+    if (tcsetattr(fd, TCSANOW, &tio) < 0)
+        return -1;
+
+#if defined(__linux__) && defined(ASYNC_LOW_LATENCY)
+    // Not a serial driver (e.g. pty) is fine.
+    struct serial_struct serial;
+    if (ioctl(fd, TIOCGSERIAL, &serial) == 0) {
+        serial.flags |= ASYNC_LOW_LATENCY;
+        ioctl(fd, TIOCSSERIAL, &serial);
+    }
+#endif
+    return 0;
+}
+
+int slip_posix_open(struct slip_posix *posix, const char *path, speed_t speed)
+{
+    SLIP_ASSERT(posix);
+    SLIP_ASSERT(path);
+
+    int fd = open(path, O_RDWR | O_NOCTTY | O_CLOEXEC);
+    if (fd < 0)
+        return -1;
+    if (slip_posix_set_raw(fd, speed) < 0) {
+        int err = errno;
+        close(fd);
+        errno = err;
+        return -1;
+    }
+    slip_posix_init(posix, fd);
+    return 0;
+}
+
+void slip_posix_close(struct slip_posix *posix)
+{
+    SLIP_ASSERT(posix);
+
+    if (posix->fd >= 0)
+        close(posix->fd);
+    posix->fd = -1;
+}
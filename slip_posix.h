@@ -0,0 +1,72 @@
+#ifndef SLIP_POSIX_H
+#define SLIP_POSIX_H
+
+#include "slip.h"
+#include <termios.h>
+
+#if defined __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Transport over a POSIX file descriptor: serial port, pty, pipe or socket.
+ * Bind it to a handler with `slip_set_transport(handler, &posix->transport)`.
+ * Its `wait()` hook is poll(), so `slip_receive_frame_timeout()` sleeps in the kernel.
+ */
+struct slip_posix {
+    int fd;
+    struct slip_transport transport;
+};
+
+/**
+ * @brief Wrap an opened file descriptor, the fd is not configured.
+ * 
+ * @param posix     Posix transport.
+ * @param fd        File descriptor, blocking or non-blocking.
+ * 
+ * @return void
+*/
+void slip_posix_init(struct slip_posix *posix, int fd);
+
+/**
+ * @brief Configure a tty in raw mode for SLIP.
+ * 
+ * 8N1, no flow control, no echo or line editing, no signal characters and no
+ * CR/LF translation. VMIN = 1 and VTIME = 0, so a read returns as soon as any
+ * byte arrives and returns all that have arrived, up to the buffer size.
+ * On Linux, the low latency flag of serial drivers is set when supported.
+ * 
+ * @param fd        Tty file descriptor.
+ * @param speed     Baud rate, e.g. B115200, 0 to keep the current one.
+ * 
+ * @return int
+ * @retval 0        Success.
+ * @retval -1       Error, see errno.
+*/
+int slip_posix_set_raw(int fd, speed_t speed);
+
+/**
+ * @brief Open a serial port or pty in raw mode and wrap it.
+ * 
+ * @param posix     Posix transport.
+ * @param path      Device path, e.g. "/dev/ttyUSB0".
+ * @param speed     Baud rate, e.g. B115200, 0 to keep the current one.
+ * 
+ * @return int
+ * @retval 0        Success.
+ * @retval -1       Error, see errno.
+*/
+int slip_posix_open(struct slip_posix *posix, const char *path, speed_t speed);
+
+/**
+ * @brief Close the wrapped file descriptor.
+ * 
+ * @return void
+*/
+void slip_posix_close(struct slip_posix *posix);
+
+#if defined __cplusplus
+}
+#endif
+
+#endif /* SLIP_POSIX_H */
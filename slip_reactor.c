@@ -0,0 +1,196 @@
+#include "slip_reactor.h"
+#include <errno.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+
+#define SLIP_REACTOR_EVENTS     64
+#define SLIP_REACTOR_READ_SIZE  (16 * 1024)
+
+struct slip_reactor_worker {
+    struct slip_reactor *reactor;
+    int epfd;
+    int wakefd;
+    pthread_t thread;
+    uint8_t buffer[SLIP_REACTOR_READ_SIZE];
+};
+
+int slip_reactor_init(struct slip_reactor *reactor, int workers)
+{
+    SLIP_ASSERT(reactor);
+    SLIP_ASSERT(workers > 0);
+
+    reactor->workers = calloc(workers, sizeof(*reactor->workers));
+    if (reactor->workers == NULL)
+        return -1;
+    reactor->count = 0;
+    reactor->started = 0;
+    atomic_init(&reactor->next, 0);
+    atomic_init(&reactor->running, 0);
+
+    for (int i = 0; i < workers; i++) {
+        struct slip_reactor_worker *worker = &reactor->workers[i];
+        struct epoll_event event = { .events = EPOLLIN, .data.ptr = NULL };
+
+        worker->reactor = reactor;
+        worker->epfd = epoll_create1(EPOLL_CLOEXEC);
+        worker->wakefd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+        if (worker->epfd < 0 || worker->wakefd < 0
+            || epoll_ctl(worker->epfd, EPOLL_CTL_ADD, worker->wakefd, &event) < 0) {
+            if (worker->epfd >= 0)
+                close(worker->epfd);
+            if (worker->wakefd >= 0)
+                close(worker->wakefd);
+            slip_reactor_deinit(reactor);
+            return -1;
+        }
+        reactor->count++;
+    }
+    return 0;
+}
+
+void slip_reactor_deinit(struct slip_reactor *reactor)
+{
+    for (int i = 0; i < reactor->count; i++) {
+        close(reactor->workers[i].epfd);
+        close(reactor->workers[i].wakefd);
+    }
+    free(reactor->workers);
+    reactor->workers = NULL;
+    reactor->count = 0;
+}
+
+int slip_reactor_add(struct slip_reactor *reactor, struct slip_link *link)
+{
+    SLIP_ASSERT(reactor);
+    SLIP_ASSERT(link && link->handler && link->on_frame);
+
+    unsigned next = atomic_fetch_add_explicit(&reactor->next, 1, memory_order_relaxed);
+    struct slip_reactor_worker *worker = &reactor->workers[next % reactor->count];
+    struct epoll_event event = { .events = EPOLLIN, .data.ptr = link };
+
+    slip_set_frame_buffer(link->handler, link->frame_buffer, link->frame_size);
+    // Set before the fd is added, the worker may see its events at once.
+    link->worker = worker;
+    if (epoll_ctl(worker->epfd, EPOLL_CTL_ADD, link->fd, &event) < 0) {
+        link->worker = NULL;
+        return -1;
+    }
+    return 0;
+}
+
+void slip_reactor_remove(struct slip_reactor *reactor, struct slip_link *link)
+{
+    (void)reactor;
+
+    if (link->worker) {
+        epoll_ctl(link->worker->epfd, EPOLL_CTL_DEL, link->fd, NULL);
+        link->worker = NULL;
+    }
+}
+
+/* Read once and dispatch all frames in the read bytes. */
+static void slip_reactor_serve(struct slip_reactor_worker *worker, struct slip_link *link)
+{
+    struct slip_decoder *decoder = &link->handler->decoder;
+    ssize_t size = read(link->fd, worker->buffer, sizeof(worker->buffer));
+
+    if (size < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR))
+        return;
+    if (size <= 0) {
+        slip_reactor_remove(worker->reactor, link);
+        if (link->on_close)
+            link->on_close(link->ctx, link);
+        return;
+    }
+
+    const uint8_t *data = worker->buffer;
+    size_t consumed;
+    while (size > 0) {
+        int ret = slip_decoder_feed(decoder, data, size, &consumed);
+        data += consumed;
+        size -= consumed;
+        if (ret > 0) {
+            link->on_frame(link->ctx, link, decoder->buffer, decoder->length);
+            // Removed in callback.
+            if (link->worker != worker)
+                return;
+        }
+    }
+}
+
+int slip_reactor_poll(struct slip_reactor *reactor, int index, int timeout)
+{
+    SLIP_ASSERT(reactor);
+    SLIP_ASSERT(index >= 0 && index < reactor->count);
+
+    struct slip_reactor_worker *worker = &reactor->workers[index];
+    struct epoll_event events[SLIP_REACTOR_EVENTS];
+    int served = 0;
+
+    int n = epoll_wait(worker->epfd, events, SLIP_REACTOR_EVENTS, timeout);
+    if (n < 0)
+        return (errno == EINTR) ? 0 : -1;
+
+    for (int i = 0; i < n; i++) {
+        struct slip_link *link = events[i].data.ptr;
+        if (link == NULL) {
+            uint64_t value;
+            // Woken up by slip_reactor_stop().
+            ssize_t ret = read(worker->wakefd, &value, sizeof(value));
+            (void)ret;
+            continue;
+        }
+        // Removed by a previous callback of this round.
+        if (link->worker != worker)
+            continue;
+        slip_reactor_serve(worker, link);
+        served++;
+    }
+    return served;
+}
+
+static void *slip_reactor_thread(void *arg)
+{
+    struct slip_reactor_worker *worker = arg;
+    struct slip_reactor *reactor = worker->reactor;
+    int index = worker - reactor->workers;
+
+    while (atomic_load(&reactor->running)) {
+        if (slip_reactor_poll(reactor, index, -1) < 0)
+            break;
+    }
+    return NULL;
+}
+
+int slip_reactor_start(struct slip_reactor *reactor)
+{
+    SLIP_ASSERT(reactor);
+
+    atomic_store(&reactor->running, 1);
+    for (int i = 0; i < reactor->count; i++) {
+        if (pthread_create(&reactor->workers[i].thread, NULL, slip_reactor_thread, &reactor->workers[i]) != 0) {
+            slip_reactor_stop(reactor);     // Stop the started ones.
+            return -1;
+        }
+        reactor->started++;
+    }
+    return 0;
+}
+
+void slip_reactor_stop(struct slip_reactor *reactor)
+{
+    SLIP_ASSERT(reactor);
+
+    uint64_t one = 1;
+    atomic_store(&reactor->running, 0);
+    for (int i = 0; i < reactor->count; i++) {
+        ssize_t ret = write(reactor->workers[i].wakefd, &one, sizeof(one));
+        (void)ret;
+    }
+    // Threads are started in worker order, join only those.
+    for (int i = 0; i < reactor->started; i++)
+        pthread_join(reactor->workers[i].thread, NULL);
+    reactor->started = 0;
+}
@@ -0,0 +1,111 @@
+#ifndef SLIP_REACTOR_H
+#define SLIP_REACTOR_H
+
+#include "slip.h"
+#include <stdatomic.h>
+#include <pthread.h>
+
+#if defined __cplusplus
+extern "C" {
+#endif
+
+struct slip_link;
+struct slip_reactor_worker;
+
+/* Called with every complete frame, on the worker thread serving the link. */
+typedef void (*slip_link_frame_t)(void *ctx, struct slip_link *link, const uint8_t *frame, size_t length);
+/* Called when the fd reaches end of file or fails, the link has been removed. */
+typedef void (*slip_link_close_t)(void *ctx, struct slip_link *link);
+
+/**
+ * A slip handler bound to a file descriptor (serial port, pty, socket ...).
+ * Fill the fields before `slip_reactor_add()`, the fd should be non-blocking.
+ */
+struct slip_link {
+    struct slip *handler;
+    int fd;
+    uint8_t *frame_buffer;      /* Decoded frame buffer. */
+    size_t frame_size;
+    slip_link_frame_t on_frame;
+    slip_link_close_t on_close; /* Optional. */
+    void *ctx;
+
+    struct slip_reactor_worker *worker;
+};
+
+/**
+ * Epoll reactor, drives many links from a few threads. Links are spread
+ * over the workers round-robin, each worker has its own epoll instance.
+ */
+struct slip_reactor {
+    struct slip_reactor_worker *workers;
+    int count;
+    int started;                /* Worker threads started, see `slip_reactor_start()`. */
+    atomic_uint next;           /* Worker of the next link. */
+    atomic_int running;
+};
+
+/**
+ * @brief Init a reactor.
+ * 
+ * @param reactor   Reactor.
+ * @param workers   Worker count, each worker is a thread after `slip_reactor_start()`.
+ * 
+ * @return int
+ * @retval 0        Success.
+ * @retval -1       Error, see errno.
+*/
+int slip_reactor_init(struct slip_reactor *reactor, int workers);
+
+/**
+ * @brief Release reactor resource, stop it first. Links' fds are not closed.
+*/
+void slip_reactor_deinit(struct slip_reactor *reactor);
+
+/**
+ * @brief Add a link to a worker, may be called from any thread while the reactor runs.
+ * 
+ * @return int
+ * @retval 0        Success.
+ * @retval -1       Error, see errno.
+*/
+int slip_reactor_add(struct slip_reactor *reactor, struct slip_link *link);
+
+/**
+ * @brief Remove a link, call it from the worker thread of the link (e.g. in
+ *        `on_frame`) or while the reactor is stopped.
+*/
+void slip_reactor_remove(struct slip_reactor *reactor, struct slip_link *link);
+
+/**
+ * @brief Wait for ready links of a worker and serve them once, in the caller's thread.
+ * 
+ * @param reactor   Reactor.
+ * @param worker    Worker index.
+ * @param timeout   Timeout in ms, -1 waits forever.
+ * 
+ * @return int
+ * @retval >=0      Served links count.
+ * @retval -1       Error, see errno.
+*/
+int slip_reactor_poll(struct slip_reactor *reactor, int worker, int timeout);
+
+/**
+ * @brief Start a thread for each worker.
+ * 
+ * @return int
+ * @retval 0        Success.
+ * @retval -1       Error.
+*/
+int slip_reactor_start(struct slip_reactor *reactor);
+
+/**
+ * @brief Stop and join the worker threads started, nothing to do if not started.
+*/
+void slip_reactor_stop(struct slip_reactor *reactor);
+
+#if defined __cplusplus
+}
+#endif
+
+#endif /* SLIP_REACTOR_H */
@@ -0,0 +1,114 @@
+#include "slip_scan.h"
+#include "slip.h"
+#include <stdatomic.h>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define SLIP_SCAN_X86
+#include <immintrin.h>
+#endif
+
+static size_t slip_scan_scalar(const uint8_t *data, size_t length)
+{
+    for (size_t i = 0; i < length; i++) {
+        if (data[i] == SLIP_END || data[i] == SLIP_ESC)
+            return i;
+    }
+    return length;
+}
+
+#ifdef SLIP_SCAN_X86
+__attribute__((target("sse2")))
+static size_t slip_scan_sse2(const uint8_t *data, size_t length)
+{
+    const __m128i end = _mm_set1_epi8((char)SLIP_END);
+    const __m128i esc = _mm_set1_epi8((char)SLIP_ESC);
+    size_t i = 0;
+
+    for (; i + 16 <= length; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(data + i));
+        __m128i m = _mm_or_si128(_mm_cmpeq_epi8(v, end), _mm_cmpeq_epi8(v, esc));
+        unsigned mask = (unsigned)_mm_movemask_epi8(m);
+        if (mask)
+            return i + __builtin_ctz(mask);
+    }
+    return i + slip_scan_scalar(data + i, length - i);
+}
+
+__attribute__((target("avx2")))
+static size_t slip_scan_avx2(const uint8_t *data, size_t length)
+{
+    const __m256i end = _mm256_set1_epi8((char)SLIP_END);
+    const __m256i esc = _mm256_set1_epi8((char)SLIP_ESC);
+    size_t i = 0;
+
+    for (; i + 32 <= length; i += 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(data + i));
+        __m256i m = _mm256_or_si256(_mm256_cmpeq_epi8(v, end), _mm256_cmpeq_epi8(v, esc));
+        unsigned mask = (unsigned)_mm256_movemask_epi8(m);
+        if (mask)
+            return i + __builtin_ctz(mask);
+    }
+    return i + slip_scan_sse2(data + i, length - i);
+}
+#endif
+
+typedef size_t (*slip_scan_fn)(const uint8_t *, size_t);
+
+static size_t slip_scan_resolve(const uint8_t *data, size_t length);
+
+/* Racing first calls all store the same pure result, a `slip_scan_select()` meanwhile is kept. */
+static _Atomic(slip_scan_fn) slip_scan_func = slip_scan_resolve;
+
+static slip_scan_fn slip_scan_auto(void)
+{
+#ifdef SLIP_SCAN_X86
+    if (__builtin_cpu_supports("avx2"))
+        return slip_scan_avx2;
+    if (__builtin_cpu_supports("sse2"))
+        return slip_scan_sse2;
+#endif
+    return slip_scan_scalar;
+}
+
+static size_t slip_scan_resolve(const uint8_t *data, size_t length)
+{
+    slip_scan_fn expected = slip_scan_resolve;
+
+    atomic_compare_exchange_strong(&slip_scan_func, &expected, slip_scan_auto());
+    return atomic_load_explicit(&slip_scan_func, memory_order_acquire)(data, length);
+}
+
+size_t slip_scan(const uint8_t *data, size_t length)
+{
+    return atomic_load_explicit(&slip_scan_func, memory_order_acquire)(data, length);
+}
+
+int slip_scan_select(SLIP_SCAN_IMPL impl)
+{
+    slip_scan_fn func;
+
+    switch (impl) {
+    case SLIP_SCAN_AUTO:
+        func = slip_scan_auto();
+        break;
+    case SLIP_SCAN_SCALAR:
+        func = slip_scan_scalar;
+        break;
+#ifdef SLIP_SCAN_X86
+    case SLIP_SCAN_SSE2:
+        if (!__builtin_cpu_supports("sse2"))
+            return -1;
+        func = slip_scan_sse2;
+        break;
+    case SLIP_SCAN_AVX2:
+        if (!__builtin_cpu_supports("avx2"))
+            return -1;
+        func = slip_scan_avx2;
+        break;
+#endif
+    default:
+        return -1;
+    }
+    atomic_store_explicit(&slip_scan_func, func, memory_order_release);
+    return 0;
+}
@@ -0,0 +1,43 @@
+#ifndef SLIP_SCAN_H
+#define SLIP_SCAN_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#if defined __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    SLIP_SCAN_AUTO = 0,     /* Best implementation supported by the CPU. */
+    SLIP_SCAN_SCALAR,
+    SLIP_SCAN_SSE2,
+    SLIP_SCAN_AVX2,
+} SLIP_SCAN_IMPL;
+
+/**
+ * @brief Find the first special byte (SLIP_END or SLIP_ESC).
+ * 
+ * @param data      Data to be scanned.
+ * @param length    Data length.
+ * 
+ * @return size_t   Index of the first special byte, `length` if not found.
+*/
+size_t slip_scan(const uint8_t *data, size_t length);
+
+/**
+ * @brief Select scan implementation, the default is chosen at runtime.
+ * 
+ * @param impl      Scan implementation.
+ * 
+ * @return int
+ * @retval 0        Success.
+ * @retval -1       Not supported by this CPU or build.
+*/
+int slip_scan_select(SLIP_SCAN_IMPL impl);
+
+#if defined __cplusplus
+}
+#endif
+
+#endif /* SLIP_SCAN_H */
@@ -0,0 +1,474 @@
+#include "slip_vj.h"
+#include <string.h>
+
+/* IPv4 header fields. */
+#define IP_LEN      2
+#define IP_ID       4
+#define IP_FRAG     6
+#define IP_PROTO    9
+#define IP_SUM      10
+#define IP_SRC      12
+#define IP_HLEN(ip) (((ip)[0] & 0x0F) << 2)
+
+#define IPPROTO_TCP_NUM 6
+
+/* TCP header fields. */
+#define TCP_SEQ     4
+#define TCP_ACK     8
+#define TCP_FLAGS   13
+#define TCP_WIN     14
+#define TCP_SUM     16
+#define TCP_URP     18
+#define TCP_HLEN(th) (((th)[12] >> 4) << 2)
+
+#define TH_FIN      0x01
+#define TH_SYN      0x02
+#define TH_RST      0x04
+#define TH_PUSH     0x08
+#define TH_ACK      0x10
+#define TH_URG      0x20
+
+/* Change mask bits of a compressed header. */
+#define NEW_C           0x40
+#define NEW_I           0x20
+#define TCP_PUSH_BIT    0x10
+#define NEW_S           0x08
+#define NEW_A           0x04
+#define NEW_W           0x02
+#define NEW_U           0x01
+
+/* Reserved, otherwise unlikely change masks. */
+#define SPECIAL_I       (NEW_S | NEW_W | NEW_U)     // Echoed interactive traffic.
+#define SPECIAL_D       (NEW_S | NEW_A | NEW_W | NEW_U)     // Unidirectional data.
+#define SPECIALS_MASK   (NEW_S | NEW_A | NEW_W | NEW_U)
+
+/* Delta of 1 ~ 255 in a byte, others are 0 followed by 16 bits. */
+#define ENCODE(n) do {                          \
+    if ((uint16_t)(n) >= 256) {                 \
+        *cp++ = 0;                              \
+        *cp++ = (uint8_t)((n) >> 8);            \
+        *cp++ = (uint8_t)(n);                   \
+    } else {                                    \
+        *cp++ = (uint8_t)(n);                   \
+    }                                           \
+} while (0)
+
+/* Same as ENCODE(), for fields where 0 is a valid delta. */
+#define ENCODEZ(n) do {                                     \
+    if ((uint16_t)(n) >= 256 || (uint16_t)(n) == 0) {       \
+        *cp++ = 0;                                          \
+        *cp++ = (uint8_t)((n) >> 8);                        \
+        *cp++ = (uint8_t)(n);                               \
+    } else {                                                \
+        *cp++ = (uint8_t)(n);                               \
+    }                                                       \
+} while (0)
+
+static uint16_t get16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] << 8 | p[1]);
+}
+
+static uint32_t get32(const uint8_t *p)
+{
+    return (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 8 | p[3];
+}
+
+static void put16(uint8_t *p, uint16_t value)
+{
+    p[0] = (uint8_t)(value >> 8);
+    p[1] = (uint8_t)value;
+}
+
+static void put32(uint8_t *p, uint32_t value)
+{
+    put16(p, (uint16_t)(value >> 16));
+    put16(p + 2, (uint16_t)value);
+}
+
+void slip_vj_init(struct slip_vj *vj, int compress_cid)
+{
+    SLIP_ASSERT(vj);
+
+    memset(vj, 0, sizeof(*vj));
+    // Send slots in a ring, tx_last is the least recently used one.
+    for (int i = 0; i < SLIP_VJ_SLOTS; i++) {
+        vj->tx[i].id   = (uint8_t)i;
+        vj->tx[i].next = (uint8_t)((i + SLIP_VJ_SLOTS - 1) % SLIP_VJ_SLOTS);
+        vj->rx[i].id   = (uint8_t)i;
+    }
+    vj->tx_last = 0;
+    vj->tx_last_id = 0xFF;
+    vj->compress_cid = compress_cid;
+    vj->rx_last_id = 0xFF;
+    vj->rx_toss = 1;
+}
+
+/* Same addresses and ports. */
+static int slip_vj_match(const struct slip_vj_slot *slot, const uint8_t *ip, const uint8_t *th)
+{
+    return slot->length != 0
+        && memcmp(&ip[IP_SRC], &slot->header[IP_SRC], 8) == 0
+        && memcmp(th, &slot->header[IP_HLEN(slot->header)], 4) == 0;
+}
+
+size_t slip_vj_compress(struct slip_vj *vj, const uint8_t *packet, size_t length,
+                        uint8_t header[SLIP_VJ_MAX_HDR], size_t *header_length)
+{
+    SLIP_ASSERT(vj);
+    SLIP_ASSERT(packet);
+    SLIP_ASSERT(header && header_length);
+
+    *header_length = 0;
+
+    // Only TCP segments with ACK and no other control bit, no fragments.
+    if (length < 40 || (packet[0] & 0xF0) != 0x40 || packet[IP_PROTO] != IPPROTO_TCP_NUM)
+        return 0;
+    size_t ip_hlen = IP_HLEN(packet);
+    if (ip_hlen < 20 || ip_hlen + 20 > length || (get16(&packet[IP_FRAG]) & 0x3FFF))
+        return 0;
+    const uint8_t *th = &packet[ip_hlen];
+    size_t hlen = ip_hlen + TCP_HLEN(th);
+    if (TCP_HLEN(th) < 20 || hlen > length || hlen > SLIP_VJ_MAX_HDR)
+        return 0;
+    if ((th[TCP_FLAGS] & (TH_SYN | TH_FIN | TH_RST | TH_ACK)) != TH_ACK)
+        return 0;
+
+    // Locate the connection, most recently used first.
+    uint8_t last = vj->tx_last, prev = last, id = vj->tx[last].next;
+    struct slip_vj_slot *cs = &vj->tx[id];
+    if (!slip_vj_match(cs, packet, th)) {
+        int found = 0;
+        do {
+            prev = id;
+            id = vj->tx[id].next;
+            cs = &vj->tx[id];
+            if (slip_vj_match(cs, packet, th)) {
+                found = 1;
+                break;
+            }
+        } while (id != last);
+
+        if (!found) {
+            // Take over the least recently used slot.
+            vj->tx_last = prev;
+            goto uncompressed;
+        }
+        // Move it to the front.
+        if (id == last) {
+            vj->tx_last = prev;
+        } else {
+            vj->tx[prev].next = cs->next;
+            cs->next = vj->tx[last].next;
+            vj->tx[last].next = id;
+        }
+    }
+
+    // Fields expected to be constant.
+    const uint8_t *oip = cs->header;
+    const uint8_t *oth = &oip[IP_HLEN(oip)];
+    if (memcmp(&packet[0], &oip[0], 2) != 0
+        || memcmp(&packet[IP_FRAG], &oip[IP_FRAG], 4) != 0
+        || TCP_HLEN(th) != TCP_HLEN(oth)
+        || memcmp(&packet[20], &oip[20], ip_hlen - 20) != 0
+        || memcmp(&th[20], &oth[20], TCP_HLEN(th) - 20) != 0)
+        goto uncompressed;
+
+    uint8_t deltas[16], *cp = deltas;
+    unsigned changes = 0;
+    uint32_t delta_s, delta_a;
+
+    if (th[TCP_FLAGS] & TH_URG) {
+        delta_s = get16(&th[TCP_URP]);
+        ENCODEZ(delta_s);
+        changes |= NEW_U;
+    } else if (get16(&th[TCP_URP]) != get16(&oth[TCP_URP])) {
+        goto uncompressed;
+    }
+    delta_s = (uint16_t)(get16(&th[TCP_WIN]) - get16(&oth[TCP_WIN]));
+    if (delta_s) {
+        ENCODE(delta_s);
+        changes |= NEW_W;
+    }
+    delta_a = get32(&th[TCP_ACK]) - get32(&oth[TCP_ACK]);
+    if (delta_a) {
+        if (delta_a > 0xFFFF)
+            goto uncompressed;
+        ENCODE(delta_a);
+        changes |= NEW_A;
+    }
+    delta_s = get32(&th[TCP_SEQ]) - get32(&oth[TCP_SEQ]);
+    if (delta_s) {
+        if (delta_s > 0xFFFF)
+            goto uncompressed;
+        ENCODE(delta_s);
+        changes |= NEW_S;
+    }
+
+    uint32_t last_data = (uint32_t)get16(&oip[IP_LEN]) - (uint32_t)hlen;
+    switch (changes) {
+    case 0:
+        // Data following a pure ack is compressed, a retransmit is not in case the other side missed it.
+        if (get16(&packet[IP_LEN]) != get16(&oip[IP_LEN]) && get16(&oip[IP_LEN]) == hlen)
+            break;
+        // fall through
+    case SPECIAL_I:
+    case SPECIAL_D:
+        // Same as a special encoding.
+        goto uncompressed;
+    case NEW_S | NEW_A:
+        if (delta_s == delta_a && delta_s == last_data) {
+            changes = SPECIAL_I;
+            cp = deltas;
+        }
+        break;
+    case NEW_S:
+        if (delta_s == last_data) {
+            changes = SPECIAL_D;
+            cp = deltas;
+        }
+        break;
+    default:    break;
+    }
+
+    delta_s = (uint16_t)(get16(&packet[IP_ID]) - get16(&oip[IP_ID]));
+    if (delta_s != 1) {
+        ENCODEZ(delta_s);
+        changes |= NEW_I;
+    }
+    if (th[TCP_FLAGS] & TH_PUSH)
+        changes |= TCP_PUSH_BIT;
+
+    memcpy(cs->header, packet, hlen);
+    cs->length = (uint16_t)hlen;
+
+    size_t n = 0;
+    if (!vj->compress_cid || vj->tx_last_id != cs->id) {
+        vj->tx_last_id = cs->id;
+        header[n++] = (uint8_t)(SLIP_VJ_TYPE_COMPRESSED_TCP | changes | NEW_C);
+        header[n++] = cs->id;
+    } else {
+        header[n++] = (uint8_t)(SLIP_VJ_TYPE_COMPRESSED_TCP | changes);
+    }
+    // TCP checksum is sent as is.
+    header[n++] = th[TCP_SUM];
+    header[n++] = th[TCP_SUM + 1];
+    memcpy(&header[n], deltas, cp - deltas);
+    *header_length = n + (cp - deltas);
+    return hlen;
+
+uncompressed:
+    // Regular header with the connection id in the protocol field.
+    memcpy(cs->header, packet, hlen);
+    cs->length = (uint16_t)hlen;
+    memcpy(header, packet, hlen);
+    header[0] |= SLIP_VJ_TYPE_UNCOMPRESSED_TCP;
+    header[IP_PROTO] = cs->id;
+    vj->tx_last_id = cs->id;
+    *header_length = hlen;
+    return hlen;
+}
+
+/* Read a delta, see ENCODE(). */
+static int slip_vj_decode(const uint8_t **cp, const uint8_t *end, uint32_t *value)
+{
+    const uint8_t *p = *cp;
+
+    if (p >= end)
+        return -1;
+    if (*p != 0) {
+        *value = *p;
+        *cp = p + 1;
+        return 0;
+    }
+    if (end - p < 3)
+        return -1;
+    *value = get16(&p[1]);
+    *cp = p + 3;
+    return 0;
+}
+
+static uint16_t slip_vj_ip_checksum(const uint8_t *ip, size_t length)
+{
+    uint32_t sum = 0;
+
+    for (size_t i = 0; i + 1 < length; i += 2)
+        sum += get16(&ip[i]);
+    while (sum >> 16)
+        sum = (sum & 0xFFFF) + (sum >> 16);
+    return (uint16_t)~sum;
+}
+
+int slip_vj_uncompress(struct slip_vj *vj, uint8_t *frame, size_t length, uint8_t **packet, size_t *packet_length)
+{
+    SLIP_ASSERT(vj);
+    SLIP_ASSERT(frame || length == 0);
+    SLIP_ASSERT(packet && packet_length);
+
+    if (length == 0)
+        goto bad;
+
+    if (!(frame[0] & SLIP_VJ_TYPE_COMPRESSED_TCP)) {
+        if (frame[0] < SLIP_VJ_TYPE_UNCOMPRESSED_TCP) {
+            // TYPE_IP, as is.
+            *packet = frame;
+            *packet_length = length;
+            return 0;
+        }
+
+        // Uncompressed TCP, save the header to the slot in the protocol field.
+        frame[0] &= 0x4F;
+        size_t ip_hlen = IP_HLEN(frame);
+        if (length < 40 || ip_hlen < 20 || ip_hlen + 20 > length)
+            goto bad;
+        size_t hlen = ip_hlen + TCP_HLEN(&frame[ip_hlen]);
+        if (TCP_HLEN(&frame[ip_hlen]) < 20 || hlen > length || hlen > SLIP_VJ_MAX_HDR || frame[IP_PROTO] >= SLIP_VJ_SLOTS)
+            goto bad;
+
+        struct slip_vj_slot *cs = &vj->rx[frame[IP_PROTO]];
+        vj->rx_last_id = frame[IP_PROTO];
+        vj->rx_toss = 0;
+        frame[IP_PROTO] = IPPROTO_TCP_NUM;
+        memcpy(cs->header, frame, hlen);
+        put16(&cs->header[IP_SUM], 0);
+        cs->length = (uint16_t)hlen;
+        *packet = frame;
+        *packet_length = length;
+        return 0;
+    }
+
+    const uint8_t *cp = frame, *end = frame + length;
+    unsigned changes = *cp++;
+    uint32_t value;
+
+    if (changes & NEW_C) {
+        if (cp >= end || *cp >= SLIP_VJ_SLOTS)
+            goto bad;
+        vj->rx_toss = 0;
+        vj->rx_last_id = *cp++;
+    } else if (vj->rx_toss) {
+        return -1;      // Implicit connection id after an error.
+    }
+
+    if (vj->rx_last_id >= SLIP_VJ_SLOTS || vj->rx[vj->rx_last_id].length == 0 || end - cp < 2)
+        goto bad;
+    struct slip_vj_slot *cs = &vj->rx[vj->rx_last_id];
+    uint8_t *ip = cs->header;
+    uint8_t *th = &ip[IP_HLEN(ip)];
+
+    th[TCP_SUM]     = *cp++;
+    th[TCP_SUM + 1] = *cp++;
+    if (changes & TCP_PUSH_BIT)
+        th[TCP_FLAGS] |= TH_PUSH;
+    else
+        th[TCP_FLAGS] &= ~TH_PUSH;
+
+    uint32_t last_data = (uint32_t)get16(&ip[IP_LEN]) - cs->length;
+    switch (changes & SPECIALS_MASK) {
+    case SPECIAL_I:
+        put32(&th[TCP_ACK], get32(&th[TCP_ACK]) + last_data);
+        put32(&th[TCP_SEQ], get32(&th[TCP_SEQ]) + last_data);
+        break;
+    case SPECIAL_D:
+        put32(&th[TCP_SEQ], get32(&th[TCP_SEQ]) + last_data);
+        break;
+    default:
+        if (changes & NEW_U) {
+            th[TCP_FLAGS] |= TH_URG;
+            if (slip_vj_decode(&cp, end, &value) < 0)
+                goto bad;
+            put16(&th[TCP_URP], (uint16_t)value);
+        } else {
+            th[TCP_FLAGS] &= ~TH_URG;
+        }
+        if (changes & NEW_W) {
+            if (slip_vj_decode(&cp, end, &value) < 0)
+                goto bad;
+            put16(&th[TCP_WIN], (uint16_t)(get16(&th[TCP_WIN]) + value));
+        }
+        if (changes & NEW_A) {
+            if (slip_vj_decode(&cp, end, &value) < 0)
+                goto bad;
+            put32(&th[TCP_ACK], get32(&th[TCP_ACK]) + value);
+        }
+        if (changes & NEW_S) {
+            if (slip_vj_decode(&cp, end, &value) < 0)
+                goto bad;
+            put32(&th[TCP_SEQ], get32(&th[TCP_SEQ]) + value);
+        }
+        break;
+    }
+    if (changes & NEW_I) {
+        if (slip_vj_decode(&cp, end, &value) < 0)
+            goto bad;
+        put16(&ip[IP_ID], (uint16_t)(get16(&ip[IP_ID]) + value));
+    } else {
+        put16(&ip[IP_ID], (uint16_t)(get16(&ip[IP_ID]) + 1));
+    }
+
+    // Put the saved header right before the data, in the headroom.
+    size_t total = cs->length + (end - cp);
+    if (total > 0xFFFF)
+        goto bad;
+    put16(&ip[IP_LEN], (uint16_t)total);
+    uint8_t *out = frame + (cp - frame) - cs->length;
+    memcpy(out, cs->header, cs->length);
+    put16(&out[IP_SUM], slip_vj_ip_checksum(out, IP_HLEN(out)));
+
+    *packet = out;
+    *packet_length = total;
+    return 0;
+
+bad:
+    vj->rx_toss = 1;
+    return -1;
+}
+
+void slip_vj_error(struct slip_vj *vj)
+{
+    SLIP_ASSERT(vj);
+
+    vj->rx_toss = 1;
+}
+
+int slip_vj_send(struct slip *handler, struct slip_vj *vj, const uint8_t *packet, size_t length)
+{
+    SLIP_ASSERT(handler);
+
+    uint8_t header[SLIP_VJ_MAX_HDR];
+    size_t header_length;
+    size_t offset = slip_vj_compress(vj, packet, length, header, &header_length);
+    struct slip_iovec iov[2] = {
+        { header, header_length },
+        { packet + offset, length - offset },
+    };
+
+    return slip_send_framev(handler, iov, ARRAY_SIZE(iov));
+}
+
+/* Frames lost by the decoder since the handler was set up. */
+static uint64_t slip_vj_rx_errors(const struct slip *handler)
+{
+    const struct slip_rx_stats *stats = &handler->decoder.stats;
+    return stats->framing_errors + stats->bad_escapes + stats->oversize + stats->fcs_errors;
+}
+
+int slip_vj_receive(struct slip *handler, struct slip_vj *vj, uint8_t *buffer, size_t size,
+                    uint8_t **packet, size_t *length)
+{
+    SLIP_ASSERT(handler);
+    SLIP_ASSERT(buffer);
+    SLIP_ASSERT(size > SLIP_VJ_MAX_HDR);
+
+    struct slip_frame frame;
+    uint64_t errors = slip_vj_rx_errors(handler);
+    int ret = slip_receive_frames(handler, &buffer[SLIP_VJ_MAX_HDR], size - SLIP_VJ_MAX_HDR, &frame, 1);
+
+    // A frame was lost, the deltas of the next ones do not apply.
+    if (ret < 0 || slip_vj_rx_errors(handler) != errors)
+        slip_vj_error(vj);
+    if (ret < 0)
+        return ret;     // Frame is too long, or closed.
+
+    return slip_vj_uncompress(vj, &buffer[SLIP_VJ_MAX_HDR + frame.offset], frame.length, packet, length);
+}
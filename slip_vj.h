@@ -0,0 +1,126 @@
+#ifndef SLIP_VJ_H
+#define SLIP_VJ_H
+
+#include "slip.h"
+
+#if defined __cplusplus
+extern "C" {
+#endif
+
+/* Connection state slots on each side, connection ids are 0 ~ SLIP_VJ_SLOTS - 1. */
+#define SLIP_VJ_SLOTS       16
+
+/* Max TCP/IP header length kept in a slot, also the headroom of received frames. */
+#define SLIP_VJ_MAX_HDR     128
+
+/* Packet type, in the high bits of the first frame byte. */
+#define SLIP_VJ_TYPE_ERROR              0x00
+#define SLIP_VJ_TYPE_IP                 0x40
+#define SLIP_VJ_TYPE_UNCOMPRESSED_TCP   0x70
+#define SLIP_VJ_TYPE_COMPRESSED_TCP     0x80
+
+struct slip_vj_slot {
+    uint8_t header[SLIP_VJ_MAX_HDR];    /* Last TCP/IP header of the connection. */
+    uint16_t length;                    /* Header length, 0 means unused. */
+    uint8_t id;
+    uint8_t next;                       /* Send side LRU ring. */
+};
+
+/**
+ * Van Jacobson TCP/IP header compression state of a link (RFC 1144), a
+ * compressor for sent packets and a decompressor for received ones.
+ */
+struct slip_vj {
+    struct slip_vj_slot tx[SLIP_VJ_SLOTS];
+    uint8_t tx_last;        /* Least recently used send slot, its `next` is the most recent one (last_cs). */
+    uint8_t tx_last_id;     /* Connection id of the last sent compressed packet. */
+    int compress_cid;       /* Omit the connection id when it is the same as last time. */
+
+    struct slip_vj_slot rx[SLIP_VJ_SLOTS];
+    uint8_t rx_last_id;
+    int rx_toss;            /* Drop packets with implicit id after an error. */
+};
+
+/**
+ * @brief Init compression state.
+ * 
+ * @param vj            Compression state.
+ * @param compress_cid  Omit repeated connection ids, both sides must agree.
+ * 
+ * @return void
+*/
+void slip_vj_init(struct slip_vj *vj, int compress_cid);
+
+/**
+ * @brief Compress the header of an IPv4 packet.
+ * 
+ * Packets other than plain TCP segments with ACK set are sent as TYPE_IP.
+ * The frame to send is `header[0 ~ *header_length)` followed by
+ * `packet[return value ~ length)`, the packet is not modified.
+ * 
+ * @param vj            Compression state.
+ * @param packet        IPv4 packet.
+ * @param length        Packet length.
+ * @param header        Buffer for the compressed (or uncompressed TCP) header.
+ * @param header_length Header length.
+ * 
+ * @return size_t       Offset of the packet bytes sent behind the header.
+*/
+size_t slip_vj_compress(struct slip_vj *vj, const uint8_t *packet, size_t length,
+                        uint8_t header[SLIP_VJ_MAX_HDR], size_t *header_length);
+
+/**
+ * @brief Restore an IPv4 packet from a received frame, in place.
+ * 
+ * @param vj            Compression state.
+ * @param frame         Received frame, SLIP_VJ_MAX_HDR bytes before it must be writable.
+ * @param length        Frame length.
+ * @param packet        Restored packet, starts at or before `frame`.
+ * @param packet_length Restored packet length.
+ * 
+ * @return int
+ * @retval 0        Success.
+ * @retval -1       Frame is dropped, bad or lost sync after an error.
+*/
+int slip_vj_uncompress(struct slip_vj *vj, uint8_t *frame, size_t length, uint8_t **packet, size_t *packet_length);
+
+/**
+ * @brief Report a lost or corrupted frame, compressed packets are dropped until
+ *        the sender resyncs with an explicit connection id.
+ * 
+ * @return void
+*/
+void slip_vj_error(struct slip_vj *vj);
+
+/**
+ * @brief Compress and send an IPv4 packet as one frame.
+ * 
+ * @return int
+ * @retval 0        Send success.
+ * @retval -1       Send failed.
+*/
+int slip_vj_send(struct slip *handler, struct slip_vj *vj, const uint8_t *packet, size_t length);
+
+/**
+ * @brief Receive a frame and restore the IPv4 packet, see `slip_receive_frame()`.
+ * 
+ * @param handler   Slip handler.
+ * @param vj        Compression state.
+ * @param buffer    Receive buffer, the first SLIP_VJ_MAX_HDR bytes are the headroom.
+ * @param size      Receive buffer size.
+ * @param packet    Restored packet, in the buffer.
+ * @param length    Restored packet length.
+ * 
+ * @return int
+ * @retval 0        Success.
+ * @retval -1       Frame is too long or dropped.
+ * @retval -3       Transport is closed or failed.
+*/
+int slip_vj_receive(struct slip *handler, struct slip_vj *vj, uint8_t *buffer, size_t size,
+                    uint8_t **packet, size_t *length);
+
+#if defined __cplusplus
+}
+#endif
+
+#endif /* SLIP_VJ_H */
@@ -0,0 +1,103 @@
+#include "spsc_ringbuffer.h"
+#include <assert.h>
+#include <string.h>
+
+static void spsc_ringbuffer_split(struct spsc_ringbuffer *rb, size_t index, size_t size,
+                                  uint8_t *ptr[2], size_t length[2])
+{
+    size_t offset = index & rb->mask;
+    size_t first  = rb->mask + 1 - offset;
+
+    if (first > size)
+        first = size;
+    ptr[0]    = &rb->buffer[offset];
+    length[0] = first;
+    ptr[1]    = &rb->buffer[0];
+    length[1] = size - first;
+}
+
+int spsc_ringbuffer_init(struct spsc_ringbuffer *rb, uint8_t *pool, size_t size)
+{
+    assert(rb);
+    assert(pool);
+
+    if (size == 0 || (size & (size - 1)) != 0)
+        return -1;
+
+    rb->buffer = pool;
+    rb->mask   = size - 1;
+    spsc_ringbuffer_reset(rb);
+    return 0;
+}
+
+void spsc_ringbuffer_reset(struct spsc_ringbuffer *rb)
+{
+    atomic_store_explicit(&rb->head, 0, memory_order_relaxed);
+    atomic_store_explicit(&rb->tail, 0, memory_order_relaxed);
+    rb->tail_cache = 0;
+    rb->head_cache = 0;
+}
+
+size_t spsc_ringbuffer_reserve_span(struct spsc_ringbuffer *rb, uint8_t *ptr[2], size_t length[2])
+{
+    size_t head = atomic_load_explicit(&rb->head, memory_order_relaxed);
+    size_t space = rb->mask + 1 - (head - rb->tail_cache);
+
+    // Only reload the consumer index when the cached one says full.
+    if (space == 0) {
+        rb->tail_cache = atomic_load_explicit(&rb->tail, memory_order_acquire);
+        space = rb->mask + 1 - (head - rb->tail_cache);
+    }
+    spsc_ringbuffer_split(rb, head, space, ptr, length);
+    return space;
+}
+
+void spsc_ringbuffer_commit(struct spsc_ringbuffer *rb, size_t length)
+{
+    size_t head = atomic_load_explicit(&rb->head, memory_order_relaxed);
+    atomic_store_explicit(&rb->head, head + length, memory_order_release);
+}
+
+size_t spsc_ringbuffer_put(struct spsc_ringbuffer *rb, const uint8_t *data, size_t length)
+{
+    uint8_t *ptr[2];
+    size_t span[2];
+    size_t space = spsc_ringbuffer_reserve_span(rb, ptr, span);
+
+    if (space < length) {
+        // Cached index may be stale, reload before dropping data.
+        rb->tail_cache = atomic_load_explicit(&rb->tail, memory_order_acquire);
+        space = spsc_ringbuffer_reserve_span(rb, ptr, span);
+        if (space < length)
+            length = space;
+    }
+
+    if (length <= span[0]) {
+        memcpy(ptr[0], data, length);
+    } else {
+        memcpy(ptr[0], data, span[0]);
+        memcpy(ptr[1], &data[span[0]], length - span[0]);
+    }
+    spsc_ringbuffer_commit(rb, length);
+    return length;
+}
+
+size_t spsc_ringbuffer_peek_span(struct spsc_ringbuffer *rb, uint8_t *ptr[2], size_t length[2])
+{
+    size_t tail = atomic_load_explicit(&rb->tail, memory_order_relaxed);
+    size_t size = rb->head_cache - tail;
+
+    // Only reload the producer index when the cached one says empty.
+    if (size == 0) {
+        rb->head_cache = atomic_load_explicit(&rb->head, memory_order_acquire);
+        size = rb->head_cache - tail;
+    }
+    spsc_ringbuffer_split(rb, tail, size, ptr, length);
+    return size;
+}
+
+void spsc_ringbuffer_consume(struct spsc_ringbuffer *rb, size_t length)
+{
+    size_t tail = atomic_load_explicit(&rb->tail, memory_order_relaxed);
+    atomic_store_explicit(&rb->tail, tail + length, memory_order_release);
+}
@@ -0,0 +1,90 @@
+#ifndef SPSC_RINGBUFFER_H
+#define SPSC_RINGBUFFER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdatomic.h>
+
+#if defined __cplusplus
+extern "C" {
+#endif
+
+#define SPSC_CACHE_LINE 64
+
+/**
+ * Lock-free single producer single consumer ring buffer.
+ *
+ * One thread (or ISR) puts data, another thread peeks and consumes it, no lock
+ * is needed. The indices are free running and the size is a power of two, so
+ * `head - tail` is the data length and `index & mask` is the position. Each
+ * side owns a cache line and keeps a cached copy of the other side's index.
+ */
+struct spsc_ringbuffer {
+    /* Producer side. */
+    _Alignas(SPSC_CACHE_LINE) atomic_size_t head;
+    size_t tail_cache;
+
+    /* Consumer side. */
+    _Alignas(SPSC_CACHE_LINE) atomic_size_t tail;
+    size_t head_cache;
+
+    _Alignas(SPSC_CACHE_LINE) uint8_t *buffer;
+    size_t mask;
+};
+
+/**
+ * @brief Init a spsc ring buffer.
+ * 
+ * @param rb        Ring buffer.
+ * @param pool      Ring buffer memory.
+ * @param size      Ring buffer size, must be a power of two.
+ * 
+ * @return int
+ * @retval 0        Success.
+ * @retval -1       Size is not a power of two.
+*/
+int spsc_ringbuffer_init(struct spsc_ringbuffer *rb, uint8_t *pool, size_t size);
+
+/**
+ * @brief Put data, producer side.
+ * 
+ * @return size_t   Length put, less than `length` if the ring buffer is full.
+*/
+size_t spsc_ringbuffer_put(struct spsc_ringbuffer *rb, const uint8_t *data, size_t length);
+
+/**
+ * @brief Get free space as up to two contiguous spans, producer side.
+ * 
+ * Write data to the spans then call `spsc_ringbuffer_commit()`.
+ * 
+ * @return size_t   Free space length.
+*/
+size_t spsc_ringbuffer_reserve_span(struct spsc_ringbuffer *rb, uint8_t *ptr[2], size_t length[2]);
+
+/**
+ * @brief Publish data written to the reserved spans, producer side.
+*/
+void spsc_ringbuffer_commit(struct spsc_ringbuffer *rb, size_t length);
+
+/**
+ * @brief Get data as up to two contiguous spans without consuming it, consumer side.
+ * 
+ * @return size_t   Data length.
+*/
+size_t spsc_ringbuffer_peek_span(struct spsc_ringbuffer *rb, uint8_t *ptr[2], size_t length[2]);
+
+/**
+ * @brief Release data returned by `spsc_ringbuffer_peek_span()`, consumer side.
+*/
+void spsc_ringbuffer_consume(struct spsc_ringbuffer *rb, size_t length);
+
+/**
+ * @brief Reset ring buffer, neither side may be in use.
+*/
+void spsc_ringbuffer_reset(struct spsc_ringbuffer *rb);
+
+#if defined __cplusplus
+}
+#endif
+
+#endif /* SPSC_RINGBUFFER_H */
@@ -1,8 +1,28 @@
+#define _GNU_SOURCE
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <pthread.h>
+#include <sched.h>
 #include <CUnit/Basic.h>
 #include <CUnit/TestDB.h>
 #include "slip.h"
+#include "slip_scan.h"
+#include "spsc_ringbuffer.h"
+#include "slip_pool.h"
+#include "slip_reactor.h"
+#include "slip_posix.h"
+#include "slip_crc.h"
+#include "slip_vj.h"
+#include "slip_parallel.h"
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+
+/* tests/test_slip_cpp.cpp */
+void test_slip_hpp(void);
+/* tests/test_slip_coro.cpp */
+void test_slip_coro(void);
 
 #define CU_ASSERT_ARRAY_EQUAL   CU_ASSERT_NSTRING_EQUAL     // when data is larger than 125, may have bug.
 
@@ -17,8 +37,9 @@ static void buffer_reset(void)
     left = right = 0;
 }
 
-static void send(uint8_t *buf, uint16_t length)
+static void send(void *user, uint8_t *buf, uint16_t length)
 {
+    (void)user;
     for (size_t i = 0; i < length; i++) {
         buffer[right++] = buf[i];
         // roll back.
@@ -31,8 +52,9 @@ static void send(uint8_t *buf, uint16_t length)
     return ;
 }
 
-static int recv(uint8_t *buf, uint16_t length)
+static int recv(void *user, uint8_t *buf, uint16_t length)
 {
+    (void)user;
     size_t i = 0;
     while (left != right) {
         // buf is full.
@@ -120,6 +142,152 @@ void test_slip_send_frame(void)
     // Send frame fail.
 }
 
+static uint8_t capture_buffer[4096];
+static size_t capture_length;
+static uint16_t capture_max_chunk;
+
+static void capture_send(void *user, uint8_t *buf, uint16_t length)
+{
+    (void)user;
+    CU_ASSERT_FATAL(capture_length + length <= ARRAY_SIZE(capture_buffer));
+    memcpy(&capture_buffer[capture_length], buf, length);
+    capture_length += length;
+    if (length > capture_max_chunk)
+        capture_max_chunk = length;
+}
+
+static size_t capture_read;
+
+static int capture_recv(void *user, uint8_t *buf, uint16_t length)
+{
+    (void)user;
+    size_t size = capture_length - capture_read;
+    if (size > length)
+        size = length;
+    memcpy(buf, &capture_buffer[capture_read], size);
+    capture_read += size;
+    return size;
+}
+
+// Per instance buffers sized for 1500 bytes MTU.
+void test_slip_jumbo_frame(void)
+{
+    static struct slip_config jumbo_config = {
+        .send = capture_send,
+        .recv = capture_recv,
+    };
+    static uint8_t rx_pool[4096];
+    static uint8_t tx_buffer[2 * 1500 + 2];
+    static uint8_t payload[1500];
+    static uint8_t frame[1500];
+    struct slip handler;
+    uint16_t length;
+
+    for (size_t i = 0; i < ARRAY_SIZE(payload); i++)
+        payload[i] = (uint8_t)(i * 31);
+
+    CU_ASSERT_EQUAL(slip_init_with_buffer(&handler, &jumbo_config, rx_pool, ARRAY_SIZE(rx_pool),
+                                          tx_buffer, ARRAY_SIZE(tx_buffer)), 0);
+    capture_length = capture_read = capture_max_chunk = 0;
+    CU_ASSERT_EQUAL(slip_send_frame(&handler, payload, ARRAY_SIZE(payload)), 0);
+    CU_ASSERT_EQUAL(slip_send_frame(&handler, payload, 100), 0);
+    CU_ASSERT(capture_length > ARRAY_SIZE(payload) + 100);
+
+    // Whole frame is received in one recv() call.
+    CU_ASSERT_EQUAL(slip_receive_frame(&handler, frame, ARRAY_SIZE(frame), &length), 0);
+    CU_ASSERT_EQUAL(length, ARRAY_SIZE(payload));
+    CU_ASSERT(memcmp(frame, payload, ARRAY_SIZE(payload)) == 0);
+    CU_ASSERT_EQUAL(capture_read, capture_length);
+    CU_ASSERT_EQUAL(slip_receive_frame(&handler, frame, ARRAY_SIZE(frame), &length), 0);
+    CU_ASSERT_EQUAL(length, 100);
+    CU_ASSERT(memcmp(frame, payload, 100) == 0);
+}
+
+// Long frame from two segments is sent in chunks without truncation.
+void test_slip_send_framev(void)
+{
+    static struct slip_config capture_config = {
+        .send = capture_send,
+        .recv = recv,
+        .chunk_size = 7,
+    };
+    struct slip handler;
+    struct slip_decoder decoder;
+    uint8_t header[3] = { 0x1, 0xC0, 0x2 };
+    uint8_t body[300];
+    uint8_t frame[ARRAY_SIZE(header) + ARRAY_SIZE(body)];
+    size_t used;
+
+    for (size_t i = 0; i < ARRAY_SIZE(body); i++)
+        body[i] = (uint8_t)(i * 7);
+    struct slip_iovec iov[] = {
+        { header, ARRAY_SIZE(header) },
+        { body, ARRAY_SIZE(body) },
+    };
+
+    capture_length = capture_max_chunk = 0;
+    slip_init(&handler, &capture_config);
+    CU_ASSERT_EQUAL(slip_send_framev(&handler, iov, ARRAY_SIZE(iov)), 0);
+    CU_ASSERT(capture_max_chunk <= 7);
+
+    slip_decoder_init(&decoder, frame, ARRAY_SIZE(frame));
+    CU_ASSERT_EQUAL(slip_decoder_feed(&decoder, capture_buffer, capture_length, &used), 1);
+    CU_ASSERT_EQUAL(used, capture_length);
+    CU_ASSERT_EQUAL(decoder.length, ARRAY_SIZE(frame));
+    CU_ASSERT(memcmp(frame, header, ARRAY_SIZE(header)) == 0);
+    CU_ASSERT(memcmp(&frame[ARRAY_SIZE(header)], body, ARRAY_SIZE(body)) == 0);
+}
+
+// Every scan implementation must encode the same as the byte by byte way, and decode it back.
+void test_slip_encode(void)
+{
+    static const SLIP_SCAN_IMPL impls[] = { SLIP_SCAN_SCALAR, SLIP_SCAN_SSE2, SLIP_SCAN_AVX2 };
+    uint8_t src[300], expect[600], dst[600];
+    size_t expect_length = 0, length, used;
+
+    srand(2);
+    for (size_t i = 0; i < ARRAY_SIZE(src); i++) {
+        src[i] = (rand() % 8 == 0) ? ((rand() & 1) ? 0xC0 : 0xDB) : (uint8_t)rand();
+        if (src[i] == 0xC0 || src[i] == 0xDB) {
+            expect[expect_length++] = 0xDB;
+            expect[expect_length++] = (src[i] == 0xC0) ? 0xDC : 0xDD;
+        } else {
+            expect[expect_length++] = src[i];
+        }
+    }
+
+    for (size_t i = 0; i < ARRAY_SIZE(impls); i++) {
+        if (slip_scan_select(impls[i]) != 0)
+            continue;
+        length = slip_encode(dst, ARRAY_SIZE(dst), src, ARRAY_SIZE(src), &used);
+        CU_ASSERT_EQUAL(used, ARRAY_SIZE(src));
+        CU_ASSERT_EQUAL(length, expect_length);
+        CU_ASSERT(memcmp(dst, expect, expect_length) == 0);
+
+        // Truncated, but an escape sequence is never split.
+        for (size_t limit = 0; limit < 40; limit++) {
+            length = slip_encode(dst, limit, src, ARRAY_SIZE(src), &used);
+            CU_ASSERT(length <= limit);
+            CU_ASSERT(length + 1 >= limit);
+            CU_ASSERT(memcmp(dst, expect, length) == 0);
+            CU_ASSERT(length == 0 || dst[length - 1] != 0xDB);
+        }
+
+        // Decode it back with the same implementation.
+        struct slip_decoder decoder;
+        uint8_t frame[ARRAY_SIZE(src)];
+        slip_decoder_init(&decoder, frame, ARRAY_SIZE(frame));
+        dst[0] = 0xC0;
+        length = 1 + slip_encode(&dst[1], ARRAY_SIZE(dst) - 2, src, ARRAY_SIZE(src), &used);
+        dst[length++] = 0xC0;
+        CU_ASSERT_EQUAL(slip_decoder_feed(&decoder, dst, length, &used), 1);
+        CU_ASSERT_EQUAL(used, length);
+        CU_ASSERT_EQUAL(decoder.length, ARRAY_SIZE(src));
+        CU_ASSERT(memcmp(frame, src, ARRAY_SIZE(src)) == 0);
+    }
+    slip_scan_select(SLIP_SCAN_AUTO);
+}
+
 // Test Decoding State.
 static uint8_t recv_buf1[] = {0xC0, 0x1, 0xC0};          // no escape
 static uint8_t recv_buf1_expect[] = { 0x1 };
@@ -194,9 +362,1178 @@ void test_slip_receive_frame(void)
     TEST_RECV_FRAME(9);
     TEST_RECV_FRAME_2(9);
 
+    // Bytes behind the frame are left untouched.
+    memset(recv_buffer, 0x55, ARRAY_SIZE(recv_buffer));
+    TEST_RECV_FRAME(1);
+    CU_ASSERT_EQUAL(recv_buffer[ARRAY_SIZE(recv_buf1_expect)], 0x55);
+
     // Receive frame fail.
 }
 
+// Test feeding decoder, frames split at every position (include ESC).
+static uint8_t feed_buf[] = { 0x1, 0xC0, 0x1, 0xDB, 0xDC, 0x2, 0xC0, 0xC0, 0xDB, 0xDD, 0xC0, 0xC0, 0x3, 0xC0 };
+static uint8_t feed_buf_expect1[] = { 0x1, 0xC0, 0x2 };
+static uint8_t feed_buf_expect2[] = { 0xDB };
+static uint8_t feed_buf_expect3[] = { 0x3 };
+
+void test_slip_decoder_feed(void)
+{
+    struct slip_decoder decoder;
+    uint8_t frame[10];
+    uint8_t *expects[] = { feed_buf_expect1, feed_buf_expect2, feed_buf_expect3 };
+    size_t expect_lengths[] = { ARRAY_SIZE(feed_buf_expect1), ARRAY_SIZE(feed_buf_expect2), ARRAY_SIZE(feed_buf_expect3) };
+
+    for (size_t split = 0; split <= ARRAY_SIZE(feed_buf); split++) {
+        const uint8_t *chunks[] = { feed_buf, feed_buf + split };
+        size_t chunk_lengths[] = { split, ARRAY_SIZE(feed_buf) - split };
+        size_t frames = 0;
+
+        slip_decoder_init(&decoder, frame, ARRAY_SIZE(frame));
+        for (size_t c = 0; c < ARRAY_SIZE(chunks); c++) {
+            const uint8_t *data = chunks[c];
+            size_t length = chunk_lengths[c];
+            while (length > 0) {
+                size_t consumed;
+                int ret = slip_decoder_feed(&decoder, data, length, &consumed);
+                CU_ASSERT(ret >= 0);
+                CU_ASSERT(consumed <= length);
+                data += consumed;
+                length -= consumed;
+                if (ret == 1) {
+                    CU_ASSERT_FATAL(frames < ARRAY_SIZE(expects));
+                    CU_ASSERT_EQUAL(decoder.length, expect_lengths[frames]);
+                    CU_ASSERT_ARRAY_EQUAL(frame, expects[frames], decoder.length);
+                    frames++;
+                }
+            }
+        }
+        CU_ASSERT_EQUAL(frames, ARRAY_SIZE(expects));
+    }
+
+    // Frame too long is dropped, following frame still decoded.
+    static uint8_t long_buf[] = { 0xC0, 0x1, 0x2, 0x3, 0xC0, 0xC0, 0x4, 0xC0 };
+    size_t consumed;
+    slip_decoder_init(&decoder, frame, 2);
+    CU_ASSERT_EQUAL(slip_decoder_feed(&decoder, long_buf, ARRAY_SIZE(long_buf), &consumed), -1);
+    CU_ASSERT_EQUAL(consumed, 4);
+    CU_ASSERT_EQUAL(decoder.state, SLIP_ERROR_STATE);
+    CU_ASSERT_EQUAL(slip_decoder_feed(&decoder, long_buf + 4, ARRAY_SIZE(long_buf) - 4, &consumed), 1);
+    CU_ASSERT_EQUAL(decoder.length, 1);
+    CU_ASSERT_EQUAL(frame[0], 0x4);
+
+    // Garbage behind a frame decoded in place must not overwrite the next frame before it is read.
+    uint8_t garbage_buf[] = { 0xC0, 0x41, 0x41, 0x41, 0x41, 0xC0, 0x55, 0x56, 0xC0, 0xC0, 0x42, 0xC0 };
+    struct slip_frame garbage_frames[4];
+    CU_ASSERT_EQUAL(slip_decode_inplace(garbage_buf, ARRAY_SIZE(garbage_buf), garbage_frames,
+                                        ARRAY_SIZE(garbage_frames), &consumed), 2);
+    CU_ASSERT_EQUAL(consumed, ARRAY_SIZE(garbage_buf));
+    CU_ASSERT_EQUAL(garbage_frames[0].length, 4);
+    CU_ASSERT(memcmp(&garbage_buf[garbage_frames[0].offset], "\x41\x41\x41\x41", 4) == 0);
+    CU_ASSERT_EQUAL(garbage_frames[1].length, 1);
+    CU_ASSERT_EQUAL(garbage_buf[garbage_frames[1].offset], 0x42);
+
+    // Bad escapes drop their frame only, the rest of it is skipped up to SLIP_END.
+    static uint8_t bad_buf[] = { 0xC0, 0x1, 0xDB, 0x2, 0x3, 0xC0, 0xC0, 0x4, 0xDB, 0xC0, 0xC0, 0x5, 0xC0 };
+    for (size_t step = 1; step <= ARRAY_SIZE(bad_buf); step++) {
+        size_t offset = 0, frames = 0;
+        slip_decoder_init(&decoder, frame, ARRAY_SIZE(frame));
+        while (offset < ARRAY_SIZE(bad_buf)) {
+            size_t length = step < ARRAY_SIZE(bad_buf) - offset ? step : ARRAY_SIZE(bad_buf) - offset;
+            int ret = slip_decoder_feed(&decoder, &bad_buf[offset], length, &consumed);
+            CU_ASSERT(ret >= 0);
+            offset += consumed;
+            if (ret == 1) {
+                CU_ASSERT_EQUAL(decoder.length, 1);
+                CU_ASSERT_EQUAL(frame[0], 0x5);
+                frames++;
+            }
+        }
+        CU_ASSERT_EQUAL(frames, 1);
+        CU_ASSERT_EQUAL(decoder.stats.frames, 1);
+        CU_ASSERT_EQUAL(decoder.stats.bad_escapes, 2);
+        CU_ASSERT_EQUAL(decoder.stats.discarded, 2);
+        CU_ASSERT_EQUAL(decoder.stats.bytes, ARRAY_SIZE(bad_buf));
+    }
+
+    // Random frames (long plain runs and escapes) fed in random chunks.
+    static uint8_t payloads[8][64], stream[8 * (2 * 64 + 2)], decoded[64];
+    size_t payload_lengths[8], stream_length = 0, used;
+    srand(19);
+    for (size_t f = 0; f < ARRAY_SIZE(payloads); f++) {
+        payload_lengths[f] = 1 + rand() % ARRAY_SIZE(payloads[f]);
+        for (size_t i = 0; i < payload_lengths[f]; i++) {
+            int r = rand() % 16;
+            payloads[f][i] = r == 0 ? SLIP_END : r == 1 ? SLIP_ESC : (uint8_t)rand();
+        }
+        stream[stream_length++] = SLIP_END;
+        stream_length += slip_encode(&stream[stream_length], ARRAY_SIZE(stream) - stream_length,
+                                     payloads[f], payload_lengths[f], &used);
+        stream[stream_length++] = SLIP_END;
+    }
+    for (int round = 0; round < 64; round++) {
+        size_t offset = 0, frames = 0;
+        slip_decoder_init(&decoder, decoded, ARRAY_SIZE(decoded));
+        while (offset < stream_length) {
+            size_t length = 1 + rand() % 24;
+            if (length > stream_length - offset)
+                length = stream_length - offset;
+            while (length > 0) {
+                int ret = slip_decoder_feed(&decoder, &stream[offset], length, &consumed);
+                CU_ASSERT(ret >= 0);
+                offset += consumed;
+                length -= consumed;
+                if (ret == 1) {
+                    CU_ASSERT_FATAL(frames < ARRAY_SIZE(payloads));
+                    CU_ASSERT_EQUAL(decoder.length, payload_lengths[frames]);
+                    CU_ASSERT(memcmp(decoded, payloads[frames], decoder.length) == 0);
+                    frames++;
+                }
+            }
+        }
+        CU_ASSERT_EQUAL(frames, ARRAY_SIZE(payloads));
+    }
+}
+
+void test_slip_decode_inplace(void)
+{
+    uint8_t buf[] = { 0x1, 0xC0, 0x1, 0xDB, 0xDC, 0x2, 0xC0, 0xC0, 0xDB, 0xDD, 0xC0, 0xC0, 0x3, 0xC0, 0xC0, 0x4 };
+    struct slip_frame frames[4];
+    size_t consumed;
+
+    int count = slip_decode_inplace(buf, ARRAY_SIZE(buf), frames, ARRAY_SIZE(frames), &consumed);
+    CU_ASSERT_EQUAL(count, 3);
+    CU_ASSERT_EQUAL(consumed, 14);      // 0xC0, 0x4 is an incomplete frame.
+    CU_ASSERT_EQUAL(frames[0].length, ARRAY_SIZE(feed_buf_expect1));
+    CU_ASSERT(memcmp(&buf[frames[0].offset], feed_buf_expect1, frames[0].length) == 0);
+    CU_ASSERT_EQUAL(frames[1].length, ARRAY_SIZE(feed_buf_expect2));
+    CU_ASSERT(memcmp(&buf[frames[1].offset], feed_buf_expect2, frames[1].length) == 0);
+    CU_ASSERT_EQUAL(frames[2].length, ARRAY_SIZE(feed_buf_expect3));
+    CU_ASSERT(memcmp(&buf[frames[2].offset], feed_buf_expect3, frames[2].length) == 0);
+
+    // Stop at max frames.
+    uint8_t buf2[] = { 0xC0, 0x1, 0xC0, 0xC0, 0x2, 0xC0 };
+    count = slip_decode_inplace(buf2, ARRAY_SIZE(buf2), frames, 1, &consumed);
+    CU_ASSERT_EQUAL(count, 1);
+    CU_ASSERT_EQUAL(consumed, 3);
+    CU_ASSERT_EQUAL(buf2[frames[0].offset], 0x1);
+
+    // Garbage only.
+    uint8_t buf3[] = { 0x1, 0x2, 0x3 };
+    count = slip_decode_inplace(buf3, ARRAY_SIZE(buf3), frames, ARRAY_SIZE(frames), &consumed);
+    CU_ASSERT_EQUAL(count, 0);
+    CU_ASSERT_EQUAL(consumed, ARRAY_SIZE(buf3));
+}
+
+// Random stream of frames, SLIP_END runs (empty frames) and garbage, cut at every kind of state.
+static uint8_t parallel_stream[1024 * 1024];
+static uint8_t parallel_copy[ARRAY_SIZE(parallel_stream)];
+static uint8_t parallel_out[ARRAY_SIZE(parallel_stream)];
+static struct slip_frame parallel_frames[ARRAY_SIZE(parallel_stream) / 2];
+static struct slip_frame parallel_expects[ARRAY_SIZE(parallel_stream) / 2];
+
+static size_t parallel_fill(unsigned seed)
+{
+    size_t length = 0, used;
+    uint8_t payload[24];
+
+    srand(seed);
+    while (length < ARRAY_SIZE(parallel_stream) - 2 * ARRAY_SIZE(payload) - 2) {
+        int kind = rand() % 8;
+        if (kind < 5) {
+            size_t n = rand() % ARRAY_SIZE(payload);
+            for (size_t i = 0; i < n; i++) {
+                int r = rand() % 8;
+                payload[i] = r == 0 ? SLIP_END : r == 1 ? SLIP_ESC : (uint8_t)rand();
+            }
+            parallel_stream[length++] = SLIP_END;
+            length += slip_encode(&parallel_stream[length], ARRAY_SIZE(parallel_stream) - length, payload, n, &used);
+            parallel_stream[length++] = SLIP_END;
+        } else if (kind < 7) {
+            for (int n = 1 + rand() % 4; n > 0; n--)
+                parallel_stream[length++] = SLIP_END;
+        } else {
+            // Garbage, SLIP_ESC in it makes bad escapes.
+            for (int n = 1 + rand() % 8; n > 0; n--) {
+                uint8_t ch;
+                do {
+                    ch = (rand() % 4 == 0) ? SLIP_ESC : (uint8_t)rand();
+                } while (ch == SLIP_END);
+                parallel_stream[length++] = ch;
+            }
+        }
+    }
+    // Trailing incomplete frame.
+    parallel_stream[length++] = SLIP_END;
+    parallel_stream[length++] = 0x1;
+    return length;
+}
+
+void test_slip_decode_parallel(void)
+{
+    static const int threads[] = { 1, 2, 3, 8, 0 };
+
+    for (size_t t = 0; t < ARRAY_SIZE(threads); t++) {
+        size_t length = parallel_fill(20 + t), consumed, expect_consumed;
+        size_t max_frames = t == ARRAY_SIZE(threads) - 1 ? 1000 : ARRAY_SIZE(parallel_frames);
+
+        memcpy(parallel_copy, parallel_stream, length);
+        int expect = slip_decode_inplace(parallel_copy, length, parallel_expects, (int)max_frames, &expect_consumed);
+        long count = slip_decode_parallel(parallel_stream, length, parallel_out, parallel_frames,
+                                          max_frames, &consumed, threads[t]);
+        CU_ASSERT_EQUAL(count, expect);
+        CU_ASSERT_EQUAL(consumed, expect_consumed);
+        if (count != expect)
+            continue;
+        for (long i = 0; i < count; i++) {
+            CU_ASSERT_EQUAL_FATAL(parallel_frames[i].length, parallel_expects[i].length);
+            CU_ASSERT(memcmp(&parallel_out[parallel_frames[i].offset],
+                             &parallel_copy[parallel_expects[i].offset], parallel_frames[i].length) == 0);
+        }
+    }
+
+    // Cut in a SLIP_END run entered in DECODING and FRAME_END, stop at every frame.
+    static const uint8_t tail[] = { 0xC0, 0xC0, 0xC0, 0xC0, 0x2, 0xC0, 0xC0, 0x3, 0xC0 };
+    size_t consumed;
+    for (size_t extra = 0; extra < 2; extra++) {
+        size_t length = SLIP_PARALLEL_MIN_CHUNK + extra;
+        memset(parallel_stream, 0x1, length);
+        parallel_stream[0] = SLIP_END;
+        parallel_stream[length - 2] = SLIP_END;
+        parallel_stream[length - 1] = SLIP_END;
+        memcpy(&parallel_stream[length], tail, ARRAY_SIZE(tail));
+        length += ARRAY_SIZE(tail);
+        for (size_t max_frames = 0; max_frames < 6; max_frames++) {
+            size_t expect_consumed;
+            memcpy(parallel_copy, parallel_stream, length);
+            int expect = slip_decode_inplace(parallel_copy, length, parallel_expects, (int)max_frames, &expect_consumed);
+            CU_ASSERT_EQUAL(slip_decode_parallel(parallel_stream, length, parallel_out, parallel_frames,
+                                                 max_frames, &consumed, 2), expect);
+            CU_ASSERT_EQUAL(consumed, expect_consumed);
+        }
+    }
+
+    // Cut behind a frame, the next chunk starts with a bad escape then a frame.
+    static const uint8_t bad[] = { 0x55, 0xDB, 0x56, 0xC0, 0xC0, 0x42, 0xC0, 0xC0, 0x43 };
+    size_t cut = SLIP_PARALLEL_MIN_CHUNK + 1;
+    memset(parallel_stream, 0x41, cut);
+    parallel_stream[0] = SLIP_END;
+    parallel_stream[cut - 1] = SLIP_END;
+    memcpy(&parallel_stream[cut], bad, ARRAY_SIZE(bad));
+    for (int n = 1; n <= 2; n++) {
+        CU_ASSERT_EQUAL(slip_decode_parallel(parallel_stream, cut + ARRAY_SIZE(bad), parallel_out, parallel_frames,
+                                             4, &consumed, n), 2);
+        CU_ASSERT_EQUAL(consumed, cut + 7);
+        CU_ASSERT_EQUAL_FATAL(parallel_frames[0].length, cut - 2);
+        CU_ASSERT(memcmp(&parallel_out[parallel_frames[0].offset], &parallel_stream[1], cut - 2) == 0);
+        CU_ASSERT_EQUAL_FATAL(parallel_frames[1].length, 1);
+        CU_ASSERT_EQUAL(parallel_out[parallel_frames[1].offset], 0x42);
+    }
+
+    // Garbage only, the input is left untouched.
+    uint8_t garbage[] = { 0x1, 0x2, 0x3 };
+    CU_ASSERT_EQUAL(slip_decode_parallel(garbage, ARRAY_SIZE(garbage), parallel_out, parallel_frames, 4, &consumed, 2), 0);
+    CU_ASSERT_EQUAL(consumed, ARRAY_SIZE(garbage));
+    CU_ASSERT_EQUAL(garbage[0], 0x1);
+}
+
+void test_slip_receive_frames(void)
+{
+    static uint8_t stream[] = { 0xC0, 0x1, 0xC0, 0xC0, 0xDB, 0xDC, 0x2, 0xC0, 0xC0, 0x3, 0xC0, 0xC0, 0x4 };
+    uint8_t arena[5];
+    struct slip_frame frames[4];
+    int count;
+
+    buffer_reset();
+    slip_reset(&slip_handler);
+    memcpy(buffer, stream, ARRAY_SIZE(stream));
+    right = ARRAY_SIZE(stream);
+
+    // The third frame does not fit in the arena, it is left to next call.
+    count = slip_receive_frames(&slip_handler, arena, 3, frames, ARRAY_SIZE(frames));
+    CU_ASSERT_EQUAL(count, 2);
+    CU_ASSERT_EQUAL(frames[0].offset, 0);
+    CU_ASSERT_EQUAL(frames[0].length, 1);
+    CU_ASSERT_EQUAL(frames[1].offset, 1);
+    CU_ASSERT_EQUAL(frames[1].length, 2);
+    CU_ASSERT_EQUAL(arena[0], 0x1);
+    CU_ASSERT_EQUAL(arena[1], 0xC0);
+    CU_ASSERT_EQUAL(arena[2], 0x2);
+
+    // 0xC0, 0x4 is incomplete and left to next call.
+    count = slip_receive_frames(&slip_handler, arena, 1, frames, ARRAY_SIZE(frames));
+    CU_ASSERT_EQUAL(count, 1);
+    CU_ASSERT_EQUAL(frames[0].length, 1);
+    CU_ASSERT_EQUAL(arena[0], 0x3);
+
+    static uint8_t tail[] = { 0x5, 0xC0 };
+    memcpy(&buffer[right], tail, ARRAY_SIZE(tail));
+    right += ARRAY_SIZE(tail);
+    count = slip_receive_frames(&slip_handler, arena, ARRAY_SIZE(arena), frames, ARRAY_SIZE(frames));
+    CU_ASSERT_EQUAL(count, 1);
+    CU_ASSERT_EQUAL(frames[0].length, 2);
+    CU_ASSERT_EQUAL(arena[0], 0x4);
+    CU_ASSERT_EQUAL(arena[1], 0x5);
+}
+
+void test_ringbuffer_span(void)
+{
+    struct rt_ringbuffer rb;
+    uint8_t pool[8];
+    uint8_t data[] = { 0x1, 0x2, 0x3, 0x4, 0x5, 0x6 };
+    rt_uint8_t *span[2];
+    rt_size_t span_length[2];
+
+    rt_ringbuffer_init(&rb, pool, ARRAY_SIZE(pool));
+    CU_ASSERT_EQUAL(rt_ringbuffer_peek_span(&rb, span, span_length), 0);
+
+    // Wrap around, data is split into two spans.
+    rt_ringbuffer_put(&rb, data, 6);
+    CU_ASSERT_EQUAL(rt_ringbuffer_consume(&rb, 5), 5);
+    rt_ringbuffer_put(&rb, data, 6);
+    CU_ASSERT_EQUAL(rt_ringbuffer_peek_span(&rb, span, span_length), 7);
+    CU_ASSERT_EQUAL(span_length[0], 3);
+    CU_ASSERT_EQUAL(span_length[1], 4);
+    CU_ASSERT_EQUAL(span[0][0], 0x6);
+    CU_ASSERT_EQUAL(span[0][1], 0x1);
+    CU_ASSERT_EQUAL(span[1][0], 0x3);
+
+    // Peek does not move the read index.
+    CU_ASSERT_EQUAL(rt_ringbuffer_data_len(&rb), 7);
+    CU_ASSERT_EQUAL(rt_ringbuffer_consume(&rb, 3), 3);
+    CU_ASSERT_EQUAL(rt_ringbuffer_peek_span(&rb, span, span_length), 4);
+    CU_ASSERT_EQUAL(span_length[0], 4);
+    CU_ASSERT_EQUAL(span_length[1], 0);
+    CU_ASSERT_EQUAL(span[0][0], 0x3);
+    CU_ASSERT_EQUAL(rt_ringbuffer_consume(&rb, 10), 4);
+    CU_ASSERT_EQUAL(rt_ringbuffer_data_len(&rb), 0);
+}
+
+// Larger than the 32KiB limit of 15 bit index, and not a power of two.
+static uint8_t large_pool[(1 << 20) + 100];
+static uint8_t large_data[300000];
+static uint8_t large_out[300000];
+
+void test_ringbuffer_large(void)
+{
+    struct rt_ringbuffer rb;
+
+    rt_ringbuffer_init(&rb, large_pool, ARRAY_SIZE(large_pool));
+    CU_ASSERT_EQUAL(rt_ringbuffer_get_size(&rb), 1 << 20);
+
+    for (size_t i = 0; i < ARRAY_SIZE(large_data); i++)
+        large_data[i] = (uint8_t)(i * 13);
+
+    // Wrap around several times.
+    for (int round = 0; round < 10; round++) {
+        CU_ASSERT_EQUAL(rt_ringbuffer_put(&rb, large_data, ARRAY_SIZE(large_data)), ARRAY_SIZE(large_data));
+        CU_ASSERT_EQUAL(rt_ringbuffer_data_len(&rb), ARRAY_SIZE(large_data));
+        CU_ASSERT_EQUAL(rt_ringbuffer_get(&rb, large_out, ARRAY_SIZE(large_out)), ARRAY_SIZE(large_out));
+        CU_ASSERT(memcmp(large_data, large_out, ARRAY_SIZE(large_data)) == 0);
+    }
+
+    // Full, then the oldest data is overwritten by force.
+    for (int i = 0; i < 4; i++)
+        rt_ringbuffer_put(&rb, large_data, ARRAY_SIZE(large_data));
+    CU_ASSERT_EQUAL(rt_ringbuffer_data_len(&rb), 1 << 20);
+    CU_ASSERT_EQUAL(rt_ringbuffer_putchar(&rb, 0x1), 0);
+    CU_ASSERT_EQUAL(rt_ringbuffer_put_force(&rb, large_data, 100), 100);
+    CU_ASSERT_EQUAL(rt_ringbuffer_data_len(&rb), 1 << 20);
+    CU_ASSERT_EQUAL(rt_ringbuffer_get(&rb, large_out, 1), 1);
+    CU_ASSERT_EQUAL(large_out[0], large_data[100]);
+}
+
+#define STRESS_BYTES    (4 * 1024 * 1024)
+#define STRESS_FRAMES   5000
+
+static struct spsc_ringbuffer stress_ring;
+static uint8_t stress_pool[64];
+static uint8_t stress_frame_pool[4096];
+
+// Spinning side yields, so the test does not crawl on a single core.
+static void stress_put(const uint8_t *data, size_t length)
+{
+    while (length > 0) {
+        size_t done = spsc_ringbuffer_put(&stress_ring, data, length);
+        if (done == 0)
+            sched_yield();
+        data += done;
+        length -= done;
+    }
+}
+
+static void *stress_byte_producer(void *arg)
+{
+    uint8_t chunk[37];
+    size_t sent = 0;
+
+    (void)arg;
+    while (sent < STRESS_BYTES) {
+        size_t length = 1 + sent % ARRAY_SIZE(chunk);
+        for (size_t i = 0; i < length; i++)
+            chunk[i] = (uint8_t)(sent + i);
+        stress_put(chunk, length);
+        sent += length;
+    }
+    return NULL;
+}
+
+static void *stress_frame_producer(void *arg)
+{
+    uint8_t stream[3 * 40];
+    uint8_t payload[20];
+    size_t used;
+
+    (void)arg;
+    for (uint32_t n = 0; n < STRESS_FRAMES; n++) {
+        size_t length = 4 + n % 16;
+        memcpy(payload, &n, sizeof(n));
+        for (size_t i = 4; i < length; i++)
+            payload[i] = (i & 1) ? 0xC0 : 0xDB;
+        size_t idx = 0;
+        stream[idx++] = 0xC0;
+        idx += slip_encode(&stream[idx], ARRAY_SIZE(stream) - 2, payload, length, &used);
+        stream[idx++] = 0xC0;
+        stress_put(stream, idx);
+    }
+    return NULL;
+}
+
+// Producer and consumer on different threads, no data is lost or reordered.
+void test_spsc_ringbuffer_stress(void)
+{
+    pthread_t producer;
+    uint8_t *span[2];
+    size_t span_length[2];
+    size_t received = 0;
+    int ok = 1;
+
+    CU_ASSERT_EQUAL(spsc_ringbuffer_init(&stress_ring, stress_pool, 48), -1);
+    CU_ASSERT_EQUAL(spsc_ringbuffer_init(&stress_ring, stress_pool, ARRAY_SIZE(stress_pool)), 0);
+    pthread_create(&producer, NULL, stress_byte_producer, NULL);
+    while (received < STRESS_BYTES) {
+        size_t size = spsc_ringbuffer_peek_span(&stress_ring, span, span_length);
+        for (int s = 0; s < 2; s++) {
+            for (size_t i = 0; i < span_length[s]; i++)
+                ok &= (span[s][i] == (uint8_t)received++);
+        }
+        spsc_ringbuffer_consume(&stress_ring, size);
+        if (size == 0)
+            sched_yield();
+    }
+    pthread_join(producer, NULL);
+    CU_ASSERT(ok);
+
+    // Decode frames from the ring.
+    struct slip handler;
+    uint8_t frame[20];
+    uint16_t length;
+    spsc_ringbuffer_init(&stress_ring, stress_frame_pool, ARRAY_SIZE(stress_frame_pool));
+    slip_init(&handler, &config);
+    slip_set_rx_ring(&handler, &stress_ring);
+    pthread_create(&producer, NULL, stress_frame_producer, NULL);
+    for (uint32_t n = 0; n < STRESS_FRAMES; n++) {
+        uint32_t seq;
+        CU_ASSERT_EQUAL(slip_receive_frame(&handler, frame, ARRAY_SIZE(frame), &length), 0);
+        memcpy(&seq, frame, sizeof(seq));
+        ok &= (seq == n && length == 4 + n % 16);
+        for (size_t i = 4; i < length; i++)
+            ok &= (frame[i] == ((i & 1) ? 0xC0 : 0xDB));
+    }
+    pthread_join(producer, NULL);
+    CU_ASSERT(ok);
+}
+
+static struct slip_pool pool;
+
+static void *pool_release_worker(void *arg)
+{
+    slip_pool_release(&pool, (uint8_t *)arg);
+    return NULL;
+}
+
+static void *pool_stress_worker(void *arg)
+{
+    uint8_t id = (uint8_t)(uintptr_t)arg;
+    uintptr_t errors = 0;
+
+    for (int i = 0; i < 100000; i++) {
+        uint8_t *block = slip_pool_acquire(&pool);
+        if (block == NULL)
+            continue;
+        memset(block, id, pool.block_size);
+        for (size_t j = 0; j < pool.block_size; j++)
+            errors += (block[j] != id);
+        slip_pool_release(&pool, block);
+    }
+    return (void *)errors;
+}
+
+// Frames are received into pool blocks and released by another thread.
+void test_slip_receive_frame_pooled(void)
+{
+    static uint64_t memory[8];
+    static uint8_t stream[] = { 0xC0, 0x1, 0xC0, 0xC0, 0x2, 0xDB, 0xDC, 0xC0, 0xC0, 0x3, 0xC0 };
+    uint8_t *frames[3];
+    uint16_t length;
+    pthread_t worker;
+
+    CU_ASSERT_EQUAL(slip_pool_init(&pool, (uint8_t *)memory, sizeof(memory), 16), 2);
+    buffer_reset();
+    slip_reset(&slip_handler);
+    slip_set_frame_pool(&slip_handler, &pool);
+    memcpy(buffer, stream, ARRAY_SIZE(stream));
+    right = ARRAY_SIZE(stream);
+
+    CU_ASSERT_EQUAL(slip_receive_frame_pooled(&slip_handler, &frames[0], &length), 0);
+    CU_ASSERT_EQUAL(length, 1);
+    CU_ASSERT_EQUAL(frames[0][0], 0x1);
+    CU_ASSERT_EQUAL(slip_receive_frame_pooled(&slip_handler, &frames[1], &length), 0);
+    CU_ASSERT_EQUAL(length, 2);
+    CU_ASSERT_EQUAL(frames[1][0], 0x2);
+    CU_ASSERT_EQUAL(frames[1][1], 0xC0);
+    CU_ASSERT(frames[0] != frames[1]);
+
+    // Pool is empty, the third frame waits.
+    CU_ASSERT_EQUAL(slip_receive_frame_pooled(&slip_handler, &frames[2], &length), -2);
+
+    pthread_create(&worker, NULL, pool_release_worker, frames[0]);
+    pthread_join(worker, NULL);
+    CU_ASSERT_EQUAL(slip_receive_frame_pooled(&slip_handler, &frames[2], &length), 0);
+    CU_ASSERT_EQUAL(length, 1);
+    CU_ASSERT_EQUAL(frames[2][0], 0x3);
+    CU_ASSERT_PTR_EQUAL(frames[2], frames[0]);
+    CU_ASSERT_EQUAL(frames[1][0], 0x2);
+
+    slip_pool_release(&pool, frames[1]);
+    slip_pool_release(&pool, frames[2]);
+    slip_set_frame_pool(&slip_handler, NULL);
+
+    // A block is never owned by two threads at once.
+    pthread_t workers[4];
+    void *errors;
+    for (uintptr_t i = 0; i < ARRAY_SIZE(workers); i++)
+        pthread_create(&workers[i], NULL, pool_stress_worker, (void *)(i + 1));
+    for (size_t i = 0; i < ARRAY_SIZE(workers); i++) {
+        pthread_join(workers[i], &errors);
+        CU_ASSERT_PTR_NULL(errors);
+    }
+}
+
+// Counters of sent, received, malformed and oversized frames.
+void test_slip_stats(void)
+{
+    struct slip handler;
+    struct slip_stats stats;
+    struct slip_decoder decoder;
+    uint8_t payload[150] = { 0x1, 0xC0, 0x2, 0xDB };
+    uint8_t frame[200];
+    uint16_t length;
+    size_t consumed;
+
+    buffer_reset();
+    slip_init(&handler, &config);
+    CU_ASSERT_EQUAL(slip_send_frame(&handler, payload, 4), 0);
+    // Truncated to SLIP_MAX_BUFFER.
+    CU_ASSERT_EQUAL(slip_send_frame(&handler, payload, ARRAY_SIZE(payload)), 0);
+    slip_get_stats(&handler, &stats);
+    CU_ASSERT_EQUAL(stats.tx.frames, 2);
+    CU_ASSERT_EQUAL(stats.tx.payload, 4 + 96);
+    CU_ASSERT_EQUAL(stats.tx.bytes, 8 + SLIP_MAX_BUFFER);
+    CU_ASSERT_EQUAL(stats.tx.escapes, 4);
+    CU_ASSERT_EQUAL(stats.tx.truncations, 1);
+
+    // Bytes behind the returned frame are not counted yet.
+    CU_ASSERT_EQUAL(slip_receive_frame(&handler, frame, ARRAY_SIZE(frame), &length), 0);
+    slip_get_stats(&handler, &stats);
+    CU_ASSERT_EQUAL(stats.rx.frames, 1);
+    CU_ASSERT_EQUAL(stats.rx.payload, 4);
+    CU_ASSERT_EQUAL(stats.rx.bytes, 8);
+    CU_ASSERT_EQUAL(stats.rx.escapes, 2);
+    CU_ASSERT_EQUAL(slip_receive_frame(&handler, frame, ARRAY_SIZE(frame), &length), 0);
+    slip_get_stats(&handler, &stats);
+    CU_ASSERT_EQUAL(stats.rx.frames, 2);
+    CU_ASSERT_EQUAL(stats.rx.payload, 4 + 96);
+    CU_ASSERT_EQUAL(stats.rx.bytes, 8 + SLIP_MAX_BUFFER);
+    CU_ASSERT_EQUAL(stats.rx.escapes, 4);
+    CU_ASSERT_EQUAL(stats.rx.framing_errors + stats.rx.oversize + stats.rx.discarded, 0);
+
+    slip_reset_stats(&handler);
+    slip_get_stats(&handler, &stats);
+    CU_ASSERT_EQUAL(stats.rx.frames + stats.rx.bytes + stats.tx.frames + stats.tx.bytes, 0);
+
+    // Noise before sync, data between frames, an oversized frame.
+    const uint8_t stream[] = { 0x7, 0x7, 0xC0, 0x1, 0xC0, 0x5, 0xC0, 0xC0, 0x1, 0x2, 0x3, 0x4, 0x5, 0x6, 0xC0,
+                               0xC0, 0xDB, 0xDD, 0xC0 };
+    const uint8_t *data = stream;
+    size_t left = ARRAY_SIZE(stream);
+    slip_decoder_init(&decoder, frame, 4);
+    while (left > 0) {
+        slip_decoder_feed(&decoder, data, left, &consumed);
+        data += consumed;
+        left -= consumed;
+    }
+    CU_ASSERT_EQUAL(decoder.stats.frames, 2);
+    CU_ASSERT_EQUAL(decoder.stats.payload, 2);
+    CU_ASSERT_EQUAL(decoder.stats.bytes, ARRAY_SIZE(stream));
+    CU_ASSERT_EQUAL(decoder.stats.escapes, 1);
+    CU_ASSERT_EQUAL(decoder.stats.framing_errors, 1);
+    CU_ASSERT_EQUAL(decoder.stats.oversize, 1);
+    CU_ASSERT_EQUAL(decoder.stats.discarded, 4);
+}
+
+// CRC-32C implementations agree, frames carry a FCS on every send path.
+void test_slip_fcs(void)
+{
+    static const SLIP_CRC_IMPL impls[] = { SLIP_CRC_TABLE, SLIP_CRC_SSE42 };
+    struct slip_config fcs_config = {
+        .send = send,
+        .recv = recv,
+        .fcs = 1,
+    };
+    struct slip handler;
+    struct slip_stats stats;
+    uint8_t data[300];
+    uint8_t frame[200];
+    uint16_t length;
+
+    for (size_t i = 0; i < ARRAY_SIZE(data); i++)
+        data[i] = (uint8_t)(i * 7 + (i >> 3));
+    for (size_t i = 0; i < ARRAY_SIZE(impls); i++) {
+        if (slip_crc32c_select(impls[i]) != 0)
+            continue;
+        CU_ASSERT_EQUAL(slip_crc32c((const uint8_t *)"123456789", 9), 0xE3069283);
+        for (size_t n = 0; n < 40; n++) {
+            uint32_t crc = slip_crc32c_update(SLIP_CRC32C_INIT, data, n);
+            crc = slip_crc32c_update(crc, &data[n], ARRAY_SIZE(data) - n);
+            CU_ASSERT_EQUAL(~crc, 0x05F85061);
+        }
+    }
+    slip_crc32c_select(SLIP_CRC_AUTO);
+
+    // FCS bytes which need escaping.
+    buffer_reset();
+    slip_init(&handler, &fcs_config);
+    for (size_t n = 0; n < 60; n += 3) {
+        CU_ASSERT_EQUAL(slip_send_frame(&handler, &data[n], n), 0);
+        CU_ASSERT_EQUAL(slip_receive_frame(&handler, frame, ARRAY_SIZE(frame), &length), 0);
+        CU_ASSERT_EQUAL(length, n);
+        CU_ASSERT(memcmp(frame, &data[n], n) == 0);
+    }
+    for (size_t n = 0; n < 60; n++) {
+        struct slip_iovec iov[2] = { { data, n }, { &data[n], 5 } };
+        CU_ASSERT_EQUAL(slip_send_framev(&handler, iov, 2), 0);
+        CU_ASSERT_EQUAL(slip_receive_frame(&handler, frame, ARRAY_SIZE(frame), &length), 0);
+        CU_ASSERT_EQUAL(length, n + 5);
+        CU_ASSERT(memcmp(frame, data, n + 5) == 0);
+    }
+
+    // A frame over the send buffer is not truncated behind a valid FCS, it is not sent.
+    slip_get_stats(&handler, &stats);
+    CU_ASSERT_EQUAL(slip_send_frame(&handler, data, SLIP_MAX_BUFFER), -1);
+    CU_ASSERT_EQUAL(handler.tx_stats.frames, stats.tx.frames);
+    // Two bytes of it are escaped.
+    CU_ASSERT_EQUAL(slip_send_frame(&handler, data, SLIP_MAX_BUFFER - 4 - 2 * SLIP_FCS_SIZE), 0);
+    CU_ASSERT_EQUAL(slip_receive_frame(&handler, frame, ARRAY_SIZE(frame), &length), 0);
+    CU_ASSERT_EQUAL(length, SLIP_MAX_BUFFER - 4 - 2 * SLIP_FCS_SIZE);
+    CU_ASSERT(memcmp(frame, data, length) == 0);
+
+    // Corrupted and short frames are dropped.
+    CU_ASSERT_EQUAL(slip_send_frame(&handler, data, 20), 0);
+    buffer[(left + 5) % ARRAY_SIZE(buffer)] ^= 0x1;
+    CU_ASSERT_EQUAL(slip_send_frame(&handler, data, 20), 0);
+    CU_ASSERT_EQUAL(slip_receive_frame(&handler, frame, ARRAY_SIZE(frame), &length), 0);
+    CU_ASSERT_EQUAL(length, 20);
+    CU_ASSERT(memcmp(frame, data, 20) == 0);
+    const uint8_t short_frame[] = { 0xC0, 0x1, 0x2, 0x3, 0xC0 };
+    send(NULL, (uint8_t *)short_frame, ARRAY_SIZE(short_frame));
+    CU_ASSERT_EQUAL(slip_send_frame(&handler, data, 10), 0);
+    CU_ASSERT_EQUAL(slip_receive_frame(&handler, frame, ARRAY_SIZE(frame), &length), 0);
+    CU_ASSERT_EQUAL(length, 10);
+    slip_get_stats(&handler, &stats);
+    CU_ASSERT_EQUAL(stats.rx.fcs_errors, 2);
+    CU_ASSERT_EQUAL(stats.rx.frames, stats.tx.frames - 1);
+    CU_ASSERT_EQUAL(stats.tx.escapes, stats.rx.escapes);
+
+    // Transport path, long runs are sent in place.
+    struct slip_posix ends[2];
+    struct slip peer;
+    int fd[2];
+    CU_ASSERT_EQUAL_FATAL(pipe(fd), 0);
+    slip_posix_init(&ends[0], fd[0]);
+    slip_posix_init(&ends[1], fd[1]);
+    slip_init(&peer, &fcs_config);
+    slip_set_transport(&peer, &ends[1].transport);
+    slip_set_transport(&handler, &ends[0].transport);
+    slip_reset(&handler);
+    CU_ASSERT_EQUAL(slip_send_frame(&peer, data, 190), 0);
+    CU_ASSERT_EQUAL(slip_receive_frame(&handler, frame, ARRAY_SIZE(frame), &length), 0);
+    CU_ASSERT_EQUAL(length, 190);
+    CU_ASSERT(memcmp(frame, data, 190) == 0);
+    slip_posix_close(&ends[0]);
+    slip_posix_close(&ends[1]);
+}
+
+/* IPv4 TCP packet from 10.0.0.1:`port` to 10.0.0.2:23, with `data` bytes of payload. */
+static size_t vj_packet(uint8_t *p, uint16_t port, uint16_t id, uint32_t seq, uint32_t ack,
+                        uint16_t window, uint8_t flags, size_t data)
+{
+    const uint8_t header[40] = {
+        0x45, 0x00, (uint8_t)((40 + data) >> 8), (uint8_t)(40 + data), (uint8_t)(id >> 8), (uint8_t)id,
+        0x40, 0x00, 64, 6, 0, 0, 10, 0, 0, 1, 10, 0, 0, 2,
+        (uint8_t)(port >> 8), (uint8_t)port, 0, 23,
+        (uint8_t)(seq >> 24), (uint8_t)(seq >> 16), (uint8_t)(seq >> 8), (uint8_t)seq,
+        (uint8_t)(ack >> 24), (uint8_t)(ack >> 16), (uint8_t)(ack >> 8), (uint8_t)ack,
+        0x50, flags, (uint8_t)(window >> 8), (uint8_t)window, (uint8_t)(seq ^ id), 0xDB, 0, 0,
+    };
+    uint32_t sum = 0;
+
+    memcpy(p, header, sizeof(header));
+    for (size_t i = 0; i < 20; i += 2)
+        sum += (uint32_t)(p[i] << 8 | p[i + 1]);
+    sum = (sum & 0xFFFF) + (sum >> 16);
+    p[10] = (uint8_t)(~sum >> 8);
+    p[11] = (uint8_t)~sum;
+    for (size_t i = 0; i < data; i++)
+        p[40 + i] = (uint8_t)(0xC0 + i + id);
+    return 40 + data;
+}
+
+// Headers of an interactive session shrink to a few bytes, and restore bit exact.
+void test_slip_vj(void)
+{
+    static const struct {
+        uint16_t port, id;
+        uint32_t seq, ack;
+        uint16_t window;
+        uint8_t flags;
+        size_t data;
+        size_t header;      // Expected compressed header length, 0 means TYPE_IP.
+        size_t offset;      // Expected data offset.
+    } packets[] = {
+        { 1000, 1, 100, 500, 4096, 0x18, 1, 40, 40 },     // New connection, uncompressed.
+        { 1000, 2, 101, 501, 4096, 0x18, 1, 3, 40 },      // Echo.
+        { 1000, 3, 102, 501, 4096, 0x10, 10, 3, 40 },     // Data after data.
+        { 1000, 4, 112, 501, 4352, 0x10, 10, 7, 40 },     // Window opens.
+        { 1001, 9, 7000, 80, 4096, 0x10, 5, 40, 40 },     // Another connection.
+        { 1001, 10, 7005, 80, 4096, 0x10, 5, 3, 40 },     // Same connection id as last one.
+        { 1000, 5, 122, 501, 4352, 0x10, 10, 4, 40 },     // Switch back, explicit connection id.
+        { 1000, 6, 132, 501, 4352, 0x10, 0, 3, 40 },      // Ack only.
+        { 1002, 1, 0, 0, 4096, 0x02, 0, 0, 0 },           // SYN, as is.
+    };
+    struct slip handler;
+    struct slip_vj sender, receiver;
+    uint8_t packet[100], header[SLIP_VJ_MAX_HDR], buffer[SLIP_VJ_MAX_HDR + 200];
+    uint8_t *restored;
+    size_t length, header_length, restored_length;
+
+    buffer_reset();
+    slip_init(&handler, &config);
+    slip_vj_init(&sender, 1);
+    slip_vj_init(&receiver, 1);
+    for (size_t i = 0; i < ARRAY_SIZE(packets); i++) {
+        length = vj_packet(packet, packets[i].port, packets[i].id, packets[i].seq, packets[i].ack,
+                           packets[i].window, packets[i].flags, packets[i].data);
+        struct slip_vj probe = sender;
+        CU_ASSERT_EQUAL(slip_vj_compress(&probe, packet, length, header, &header_length), packets[i].offset);
+        CU_ASSERT_EQUAL(header_length, packets[i].header);
+
+        CU_ASSERT_EQUAL(slip_vj_send(&handler, &sender, packet, length), 0);
+        CU_ASSERT_EQUAL(slip_vj_receive(&handler, &receiver, buffer, ARRAY_SIZE(buffer), &restored, &restored_length), 0);
+        CU_ASSERT_EQUAL(restored_length, length);
+        CU_ASSERT(memcmp(restored, packet, length) == 0);
+    }
+
+    // After a lost frame, compressed packets are dropped until a retransmit resyncs.
+    length = vj_packet(packet, 1000, 7, 132, 501, 4352, 0x10, 10);
+    slip_vj_error(&receiver);
+    CU_ASSERT_EQUAL(slip_vj_send(&handler, &sender, packet, length), 0);
+    CU_ASSERT_EQUAL(slip_vj_receive(&handler, &receiver, buffer, ARRAY_SIZE(buffer), &restored, &restored_length), -1);
+    CU_ASSERT_EQUAL(slip_vj_send(&handler, &sender, packet, length), 0);
+    CU_ASSERT_EQUAL(slip_vj_receive(&handler, &receiver, buffer, ARRAY_SIZE(buffer), &restored, &restored_length), 0);
+    CU_ASSERT_EQUAL(restored_length, length);
+    CU_ASSERT(memcmp(restored, packet, length) == 0);
+}
+
+struct frame_sink {
+    uint8_t frames[8][32];
+    size_t lengths[8];
+    int count;
+};
+
+static void sink_on_frame(void *user, const uint8_t *frame, size_t length)
+{
+    struct frame_sink *sink = user;
+
+    CU_ASSERT_FATAL(sink->count < (int)ARRAY_SIZE(sink->frames) && length <= ARRAY_SIZE(sink->frames[0]));
+    memcpy(sink->frames[sink->count], frame, length);
+    sink->lengths[sink->count++] = length;
+}
+
+// Frames are handed to on_frame() with the user context, from pushed bytes or a poll.
+void test_slip_on_frame(void)
+{
+    struct frame_sink sink = { .count = 0 };
+    struct slip_config callback_config = {
+        .send = send,
+        .recv = recv,
+        .on_frame = sink_on_frame,
+        .user = &sink,
+    };
+    struct slip handler;
+    uint8_t frame[16];
+    const uint8_t stream[] = { 0xC0, 0x1, 0xDB, 0xDC, 0xC0, 0xC0, 0x2, 0xDB, 0xDD, 0x3, 0xC0, 0xC0, 0x4 };
+    uint8_t payload[12] = { 0x5, 0xC0, 0x6 };
+
+    slip_init(&handler, &callback_config);
+    slip_set_frame_buffer(&handler, frame, ARRAY_SIZE(frame));
+
+    // Byte by byte, as from an ISR.
+    for (size_t i = 0; i < ARRAY_SIZE(stream); i++)
+        CU_ASSERT_EQUAL(slip_input(&handler, &stream[i], 1), (i == 4 || i == 10) ? 1 : 0);
+    CU_ASSERT_EQUAL(sink.count, 2);
+    CU_ASSERT_EQUAL(sink.lengths[0], 2);
+    CU_ASSERT(memcmp(sink.frames[0], "\x01\xC0", 2) == 0);
+    CU_ASSERT_EQUAL(sink.lengths[1], 3);
+    CU_ASSERT(memcmp(sink.frames[1], "\x02\xDB\x03", 3) == 0);
+
+    // Pending frame is completed, the oversized one is dropped.
+    const uint8_t tail[] = { 0x4, 0xC0, 0xC0, 0x1, 0x1, 0x1, 0x1, 0x1, 0x1, 0x1, 0x1, 0x1, 0x1, 0x1, 0x1, 0x1, 0x1,
+                             0x1, 0x1, 0x1, 0xC0, 0xC0, 0x7, 0xC0 };
+    CU_ASSERT_EQUAL(slip_input(&handler, tail, ARRAY_SIZE(tail)), 2);
+    CU_ASSERT_EQUAL(sink.count, 4);
+    CU_ASSERT_EQUAL(sink.lengths[2], 2);
+    CU_ASSERT(memcmp(sink.frames[2], "\x04\x04", 2) == 0);
+    CU_ASSERT_EQUAL(sink.lengths[3], 1);
+    CU_ASSERT_EQUAL(sink.frames[3][0], 0x7);
+
+    // Sent frames come back by slip_poll().
+    buffer_reset();
+    sink.count = 0;
+    slip_reset(&handler);
+    CU_ASSERT_EQUAL(slip_send_frame(&handler, payload, 3), 0);
+    CU_ASSERT_EQUAL(slip_send_frame(&handler, payload, ARRAY_SIZE(payload)), 0);
+    int count = 0;
+    while (count < 2)
+        count += slip_poll(&handler);
+    CU_ASSERT_EQUAL(count, 2);
+    CU_ASSERT_EQUAL(sink.lengths[0], 3);
+    CU_ASSERT(memcmp(sink.frames[0], payload, 3) == 0);
+    CU_ASSERT_EQUAL(sink.lengths[1], ARRAY_SIZE(payload));
+    CU_ASSERT(memcmp(sink.frames[1], payload, ARRAY_SIZE(payload)) == 0);
+}
+
+// Frames with specials, tty control characters and long runs over a raw pty pair.
+void test_slip_posix(void)
+{
+    static struct slip_config transport_config;
+    static uint8_t rx_pool[4096];
+    static uint8_t payload[1500];
+    static uint8_t frame[1500];
+    struct slip_posix master, slave;
+    struct slip host, device;
+    uint16_t length;
+
+    for (size_t i = 0; i < ARRAY_SIZE(payload); i++) {
+        if (i < 200)
+            payload[i] = (i % 3 == 0) ? SLIP_END : (i % 3 == 1) ? SLIP_ESC : (uint8_t)i;
+        else
+            payload[i] = (i % 80 == 0) ? SLIP_END : (uint8_t)i;
+    }
+
+    int fd = posix_openpt(O_RDWR | O_NOCTTY);
+    CU_ASSERT_FATAL(fd >= 0);
+    CU_ASSERT_FATAL(grantpt(fd) == 0 && unlockpt(fd) == 0);
+    slip_posix_init(&master, fd);
+    CU_ASSERT_EQUAL_FATAL(slip_posix_open(&slave, ptsname(fd), B115200), 0);
+
+    slip_init_with_buffer(&host, &transport_config, rx_pool, ARRAY_SIZE(rx_pool), NULL, 0);
+    slip_init(&device, &transport_config);
+    slip_set_transport(&host, &master.transport);
+    slip_set_transport(&device, &slave.transport);
+
+    // Long frame is not truncated, and gathered in several writev() calls.
+    CU_ASSERT_EQUAL(slip_send_frame(&device, payload, ARRAY_SIZE(payload)), 0);
+    CU_ASSERT_EQUAL(slip_send_frame(&device, payload, 3), 0);
+    CU_ASSERT_EQUAL(slip_receive_frame(&host, frame, ARRAY_SIZE(frame), &length), 0);
+    CU_ASSERT_EQUAL(length, ARRAY_SIZE(payload));
+    CU_ASSERT(memcmp(frame, payload, ARRAY_SIZE(payload)) == 0);
+    CU_ASSERT_EQUAL(slip_receive_frame(&host, frame, ARRAY_SIZE(frame), &length), 0);
+    CU_ASSERT_EQUAL(length, 3);
+    CU_ASSERT(memcmp(frame, payload, 3) == 0);
+
+    // Header and payload, the other way.
+    for (int n = 1; n < 40; n++) {
+        struct slip_iovec iov[2] = {
+            { &payload[n], 2 },
+            { &payload[200 + n], n },
+        };
+        CU_ASSERT_EQUAL(slip_send_framev(&host, iov, 2), 0);
+        CU_ASSERT_EQUAL(slip_receive_frame(&device, frame, ARRAY_SIZE(frame), &length), 0);
+        CU_ASSERT_EQUAL(length, n + 2);
+        CU_ASSERT(memcmp(frame, &payload[n], 2) == 0);
+        CU_ASSERT(memcmp(&frame[2], &payload[200 + n], n) == 0);
+    }
+
+    slip_posix_close(&slave);
+    slip_posix_close(&master);
+}
+
+static int wait_calls;
+static int wait_timeout;
+static int wait_ready;
+
+// Nothing to receive until the wait hook is called with a timeout, then one frame.
+static int wait_recv(void *user, uint8_t *buffer, uint16_t length)
+{
+    static const uint8_t frame[] = { SLIP_END, 0x1, SLIP_ESC, SLIP_ESC_END, 0x2, SLIP_END };
+
+    (void)user;
+    if (!wait_ready || length < sizeof(frame))
+        return 0;
+    wait_ready = 0;
+    memcpy(buffer, frame, sizeof(frame));
+    return sizeof(frame);
+}
+
+static int wait_hook(void *user, int timeout_ms)
+{
+    (void)user;
+    wait_calls++;
+    wait_timeout = timeout_ms;
+    wait_ready = timeout_ms < 0;
+    return timeout_ms < 0;
+}
+
+// One byte of a frame which never ends per call, slowly.
+static int trickle_recv(void *user, uint8_t *buffer, uint16_t length)
+{
+    static const struct timespec delay = { 0, 1000000 };
+    int *calls = user;
+
+    (void)length;
+    nanosleep(&delay, NULL);
+    buffer[0] = (*calls)++ == 0 ? SLIP_END : 0x41;
+    return 1;
+}
+
+static long elapsed_ms(const struct timespec *start)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) * 1000 + (now.tv_nsec - start->tv_nsec) / 1000000;
+}
+
+// Idle links sleep in the wait hook, a timeout bounds the whole receive.
+void test_slip_receive_timeout(void)
+{
+    struct slip_config wait_config = {
+        .send = send,
+        .recv = wait_recv,
+        .wait = wait_hook,
+    };
+    struct slip handler;
+    struct slip_posix ends[2];
+    struct timespec start;
+    uint8_t frame[16];
+    uint16_t length;
+    int fd[2];
+
+    slip_init(&handler, &wait_config);
+    wait_calls = 0;
+    CU_ASSERT_EQUAL(slip_receive_frame_timeout(&handler, frame, ARRAY_SIZE(frame), &length, 50), -2);
+    CU_ASSERT_EQUAL(wait_calls, 1);
+    CU_ASSERT(wait_timeout >= 0 && wait_timeout <= 50);
+    // Without a timeout, recv() returning nothing leads to the hook, not to a spin.
+    CU_ASSERT_EQUAL(slip_receive_frame(&handler, frame, ARRAY_SIZE(frame), &length), 0);
+    CU_ASSERT_EQUAL(wait_calls, 2);
+    CU_ASSERT_EQUAL(wait_timeout, -1);
+    CU_ASSERT_EQUAL(length, 3);
+    CU_ASSERT(frame[0] == 0x1 && frame[1] == SLIP_END && frame[2] == 0x2);
+
+    // Bytes keep coming without a frame end, the timeout still holds.
+    int trickle_calls = 0;
+    struct slip_config trickle_config = {
+        .user = &trickle_calls,
+        .send = send,
+        .recv = trickle_recv,
+    };
+    uint8_t trickle_frame[1000];
+    slip_init(&handler, &trickle_config);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    CU_ASSERT_EQUAL(slip_receive_frame_timeout(&handler, trickle_frame, ARRAY_SIZE(trickle_frame), &length, 20), -2);
+    CU_ASSERT(elapsed_ms(&start) < 500);
+
+    // Poll on a pipe, a partial frame is kept across timeouts.
+    CU_ASSERT_EQUAL_FATAL(pipe(fd), 0);
+    slip_posix_init(&ends[0], fd[0]);
+    slip_posix_init(&ends[1], fd[1]);
+    slip_init(&handler, &config);
+    slip_set_transport(&handler, &ends[0].transport);
+    CU_ASSERT_EQUAL(slip_receive_frame_timeout(&handler, frame, ARRAY_SIZE(frame), &length, 0), -2);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    CU_ASSERT_EQUAL(slip_receive_frame_timeout(&handler, frame, ARRAY_SIZE(frame), &length, 30), -2);
+    CU_ASSERT(elapsed_ms(&start) >= 29);
+    CU_ASSERT_EQUAL(write(fd[1], "\xC0\x01\x02", 3), 3);
+    CU_ASSERT_EQUAL(slip_receive_frame_timeout(&handler, frame, ARRAY_SIZE(frame), &length, 10), -2);
+    CU_ASSERT_EQUAL(write(fd[1], "\x03\xC0", 2), 2);
+    CU_ASSERT_EQUAL(slip_receive_frame_timeout(&handler, frame, ARRAY_SIZE(frame), &length, 1000), 0);
+    CU_ASSERT_EQUAL(length, 3);
+    CU_ASSERT(memcmp(frame, "\x01\x02\x03", 3) == 0);
+
+    // A partial frame is dropped when the next call is given another buffer.
+    uint8_t *small = malloc(16);
+    memset(trickle_frame, 0x41, 101);
+    trickle_frame[0] = SLIP_END;
+    CU_ASSERT_EQUAL(write(fd[1], trickle_frame, 101), 101);
+    CU_ASSERT_EQUAL(slip_receive_frame_timeout(&handler, trickle_frame, ARRAY_SIZE(trickle_frame), &length, 10), -2);
+    memset(trickle_frame, 0x41, 20);
+    memcpy(&trickle_frame[20], "\xC0\xC0\x07\xC0", 4);
+    CU_ASSERT_EQUAL(write(fd[1], trickle_frame, 24), 24);
+    CU_ASSERT_EQUAL(slip_receive_frame_timeout(&handler, small, 16, &length, 1000), 0);
+    CU_ASSERT_EQUAL(length, 1);
+    CU_ASSERT_EQUAL(small[0], 0x7);
+    CU_ASSERT_EQUAL(handler.decoder.stats.oversize, 1);
+    free(small);
+
+    // The peer closes behind a frame: the frame is received, then the end of stream, without spinning.
+    CU_ASSERT_EQUAL(write(fd[1], "\xC0\x09\xC0", 3), 3);
+    slip_posix_close(&ends[1]);
+    CU_ASSERT_EQUAL(slip_receive_frame_timeout(&handler, frame, ARRAY_SIZE(frame), &length, 300), 0);
+    CU_ASSERT(length == 1 && frame[0] == 0x9);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    CU_ASSERT_EQUAL(slip_receive_frame_timeout(&handler, frame, ARRAY_SIZE(frame), &length, 300), -3);
+    CU_ASSERT(elapsed_ms(&start) < 100);
+    CU_ASSERT_EQUAL(slip_receive_frame(&handler, frame, ARRAY_SIZE(frame), &length), -3);
+    slip_posix_close(&ends[0]);
+}
+
+#define REACTOR_LINKS   8
+#define REACTOR_FRAMES  200
+
+struct reactor_peer {
+    int fd[2];
+    struct slip handler;
+    struct slip_link link;
+    uint8_t frame[64];
+    int expect;
+    int errors;
+    int closed;
+};
+
+static atomic_int reactor_received;
+
+static void reactor_on_frame(void *ctx, struct slip_link *link, const uint8_t *frame, size_t length)
+{
+    struct reactor_peer *peer = ctx;
+    (void)link;
+
+    // Frame is "link index, sequence, sequence ^ 0xC0 ..." with specials inside.
+    if (length != 3 + (size_t)(peer->expect % 7) || frame[1] != (uint8_t)peer->expect
+        || frame[2] != (uint8_t)(peer->expect ^ 0xC0))
+        peer->errors++;
+    peer->expect++;
+    atomic_fetch_add(&reactor_received, 1);
+}
+
+static void reactor_on_close(void *ctx, struct slip_link *link)
+{
+    struct reactor_peer *peer = ctx;
+    (void)link;
+    peer->closed = 1;
+}
+
+static void reactor_write_frame(int fd, int index, int seq)
+{
+    uint8_t payload[16], stream[2 * ARRAY_SIZE(payload) + 2];
+    size_t length = 3 + seq % 7, used, idx = 0;
+
+    memset(payload, SLIP_ESC, sizeof(payload));
+    payload[0] = (uint8_t)index;
+    payload[1] = (uint8_t)seq;
+    payload[2] = (uint8_t)(seq ^ 0xC0);
+    stream[idx++] = SLIP_END;
+    idx += slip_encode(&stream[idx], ARRAY_SIZE(stream) - 2, payload, length, &used);
+    stream[idx++] = SLIP_END;
+    CU_ASSERT_FATAL(write(fd, stream, idx) == (ssize_t)idx);
+}
+
+// Many links served by two worker threads, then by the caller's thread.
+void test_slip_reactor(void)
+{
+    static struct reactor_peer peers[REACTOR_LINKS];
+    struct slip_reactor reactor;
+
+    // Never started, nothing to join. A link failing to be added is not registered.
+    CU_ASSERT_EQUAL_FATAL(slip_reactor_init(&reactor, 2), 0);
+    slip_reactor_stop(&reactor);
+    slip_init(&peers[0].handler, &config);
+    peers[0].link = (struct slip_link) {
+        .handler = &peers[0].handler,
+        .fd = -1,
+        .frame_buffer = peers[0].frame,
+        .frame_size = ARRAY_SIZE(peers[0].frame),
+        .on_frame = reactor_on_frame,
+    };
+    CU_ASSERT_EQUAL(slip_reactor_add(&reactor, &peers[0].link), -1);
+    CU_ASSERT_PTR_NULL(peers[0].link.worker);
+    slip_reactor_deinit(&reactor);
+
+    CU_ASSERT_EQUAL_FATAL(slip_reactor_init(&reactor, 2), 0);
+    atomic_store(&reactor_received, 0);
+
+    for (int i = 0; i < REACTOR_LINKS; i++) {
+        struct reactor_peer *peer = &peers[i];
+        memset(peer, 0, sizeof(*peer));
+        CU_ASSERT_EQUAL_FATAL(pipe(peer->fd), 0);
+        fcntl(peer->fd[0], F_SETFL, fcntl(peer->fd[0], F_GETFL) | O_NONBLOCK);
+        slip_init(&peer->handler, &config);
+        peer->link = (struct slip_link) {
+            .handler = &peer->handler,
+            .fd = peer->fd[0],
+            .frame_buffer = peer->frame,
+            .frame_size = ARRAY_SIZE(peer->frame),
+            .on_frame = reactor_on_frame,
+            .on_close = reactor_on_close,
+            .ctx = peer,
+        };
+        CU_ASSERT_EQUAL(slip_reactor_add(&reactor, &peer->link), 0);
+    }
+
+    CU_ASSERT_EQUAL_FATAL(slip_reactor_start(&reactor), 0);
+    for (int seq = 0; seq < REACTOR_FRAMES; seq++) {
+        for (int i = 0; i < REACTOR_LINKS; i++)
+            reactor_write_frame(peers[i].fd[1], i, seq);
+        if (seq % 16 == 0)
+            sched_yield();
+    }
+    for (int spin = 0; atomic_load(&reactor_received) < REACTOR_LINKS * REACTOR_FRAMES && spin < 100000; spin++)
+        usleep(100);
+    slip_reactor_stop(&reactor);
+
+    CU_ASSERT_EQUAL(atomic_load(&reactor_received), REACTOR_LINKS * REACTOR_FRAMES);
+    for (int i = 0; i < REACTOR_LINKS; i++) {
+        CU_ASSERT_EQUAL(peers[i].expect, REACTOR_FRAMES);
+        CU_ASSERT_EQUAL(peers[i].errors, 0);
+    }
+
+    // Caller driven, peer closed.
+    reactor_write_frame(peers[0].fd[1], 0, REACTOR_FRAMES);
+    close(peers[0].fd[1]);
+    CU_ASSERT(slip_reactor_poll(&reactor, 0, 1000) >= 1);
+    CU_ASSERT_EQUAL(peers[0].expect, REACTOR_FRAMES + 1);
+    while (!peers[0].closed && slip_reactor_poll(&reactor, 0, 1000) > 0);
+    CU_ASSERT_EQUAL(peers[0].closed, 1);
+    CU_ASSERT_EQUAL(peers[0].errors, 0);
+
+    for (int i = 0; i < REACTOR_LINKS; i++) {
+        slip_reactor_remove(&reactor, &peers[i].link);
+        close(peers[i].fd[0]);
+        if (i != 0)
+            close(peers[i].fd[1]);
+    }
+    slip_reactor_deinit(&reactor);
+}
+
 /* The main() function for setting up and running the tests.
  * Returns a CUE_SUCCESS on successful running, another
  * CUnit error code on failure.
@@ -211,7 +1548,27 @@ int main()
 
     CU_TestInfo test_array[] = {
         {"test slip send frame", test_slip_send_frame},
+        {"test slip send framev", test_slip_send_framev},
+        {"test slip jumbo frame", test_slip_jumbo_frame},
+        {"test slip encode", test_slip_encode},
         {"test slip receive frame", test_slip_receive_frame},
+        {"test slip receive frames", test_slip_receive_frames},
+        {"test slip receive frame pooled", test_slip_receive_frame_pooled},
+        {"test slip decoder feed", test_slip_decoder_feed},
+        {"test slip on frame", test_slip_on_frame},
+        {"test slip stats", test_slip_stats},
+        {"test slip fcs", test_slip_fcs},
+        {"test slip vj", test_slip_vj},
+        {"test slip decode inplace", test_slip_decode_inplace},
+        {"test slip decode parallel", test_slip_decode_parallel},
+        {"test ringbuffer span", test_ringbuffer_span},
+        {"test ringbuffer large", test_ringbuffer_large},
+        {"test spsc ringbuffer stress", test_spsc_ringbuffer_stress},
+        {"test slip reactor", test_slip_reactor},
+        {"test slip posix", test_slip_posix},
+        {"test slip receive timeout", test_slip_receive_timeout},
+        {"test slip hpp", test_slip_hpp},
+        {"test slip coro", test_slip_coro},
         CU_TEST_INFO_NULL,
     };
 
@@ -0,0 +1,106 @@
+#include <CUnit/Basic.h>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <sys/socket.h>
+#include "slip_coro.hpp"
+
+namespace {
+
+using CoroLink = slip_cpp::AsyncLink<1500, 512>;
+
+constexpr int LINKS = 32;
+constexpr int FRAMES = 100;
+
+std::atomic<int> done{ 0 };
+std::atomic<int> errors{ 0 };
+
+// Frame `n` of a link, its length and contents depend on `n`, with SLIP_END/SLIP_ESC in it.
+std::size_t make_frame(std::uint8_t *frame, int n)
+{
+    std::size_t length = 1 + (static_cast<std::size_t>(n) * 397) % CoroLink::max_frame;
+    for (std::size_t i = 0; i < length; i++)
+        frame[i] = static_cast<std::uint8_t>((i % 7 == 0) ? SLIP_END : (i % 11 == 0) ? SLIP_ESC : i + n);
+    return length;
+}
+
+slip_cpp::Task sender(slip_cpp::Executor &executor, CoroLink &link)
+{
+    std::array<std::uint8_t, CoroLink::max_frame + 1> frame;
+
+    co_await executor.schedule();
+    for (int n = 0; n < FRAMES; n++) {
+        std::size_t length = make_frame(frame.data(), n);
+        if (co_await link.send(slip_cpp::span<const std::uint8_t>(frame.data(), length)) != 0)
+            errors++;
+    }
+    if (co_await link.send(frame) != -1)          // Longer than max_frame.
+        errors++;
+    shutdown(link.fd(), SHUT_WR);
+    done++;
+}
+
+slip_cpp::Task receiver(slip_cpp::Executor &executor, CoroLink &link)
+{
+    std::array<std::uint8_t, CoroLink::max_frame> expected;
+    int n = 0;
+
+    co_await executor.schedule();
+    while (auto frame = co_await link.receive()) {
+        std::size_t length = make_frame(expected.data(), n++);
+        if (frame->size() != length || std::memcmp(frame->data(), expected.data(), length) != 0)
+            errors++;
+    }
+    if (n != FRAMES || link.rx_stats().frames != FRAMES)
+        errors++;
+    done++;
+}
+
+} // namespace
+
+extern "C" void test_slip_coro(void)
+{
+    slip_cpp::Executor executor;
+    std::vector<std::unique_ptr<CoroLink>> links;
+    std::vector<int> fds;
+
+    CU_ASSERT_FATAL(executor.valid());
+
+    // Small socket buffers, so senders wait for room to write.
+    for (int i = 0; i < LINKS; i++) {
+        int sv[2];
+        int size = 4096;
+        CU_ASSERT_FATAL(socketpair(AF_UNIX, SOCK_STREAM, 0, sv) == 0);
+        setsockopt(sv[0], SOL_SOCKET, SO_SNDBUF, &size, sizeof(size));
+        setsockopt(sv[1], SOL_SOCKET, SO_RCVBUF, &size, sizeof(size));
+        fds.push_back(sv[0]);
+        fds.push_back(sv[1]);
+        links.push_back(std::make_unique<CoroLink>(executor, sv[0]));
+        links.push_back(std::make_unique<CoroLink>(executor, sv[1]));
+    }
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 3; i++)
+        threads.emplace_back([&executor] { executor.run(); });
+
+    for (int i = 0; i < LINKS; i++) {
+        receiver(executor, *links[2 * i + 1]);
+        sender(executor, *links[2 * i]);
+    }
+
+    for (int i = 0; i < 1000 && done.load() < 2 * LINKS; i++)
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+    executor.stop();
+    for (auto &thread : threads)
+        thread.join();
+
+    CU_ASSERT_EQUAL(done.load(), 2 * LINKS);
+    CU_ASSERT_EQUAL(errors.load(), 0);
+    CU_ASSERT_EQUAL(links[0]->tx_stats().frames, FRAMES);
+
+    links.clear();
+    for (int fd : fds)
+        close(fd);
+}
@@ -0,0 +1,76 @@
+#include <CUnit/Basic.h>
+#include <algorithm>
+#include <vector>
+#include "slip.hpp"
+
+namespace {
+
+// Loopback transport, reads at most `chunk` bytes at once.
+struct Loopback {
+    std::array<std::uint8_t, 4096> data{};
+    std::size_t head = 0;
+    std::size_t tail = 0;
+    std::size_t chunk;
+
+    explicit Loopback(std::size_t chunk) : chunk(chunk) {}
+
+    void write(const std::uint8_t *bytes, std::size_t length)
+    {
+        std::memcpy(&data[tail], bytes, length);
+        tail += length;
+    }
+
+    std::size_t read(std::uint8_t *buffer, std::size_t size)
+    {
+        std::size_t n = std::min({ size, tail - head, chunk });
+        std::memcpy(buffer, &data[head], n);
+        head += n;
+        return n;
+    }
+};
+
+using TestLink = slip_cpp::Link<Loopback, 16, 8>;
+
+static_assert(TestLink::max_frame == 16 && TestLink::tx_size == 34 && TestLink::read_size == 8);
+static_assert(!std::is_polymorphic_v<TestLink>);
+static_assert(!slip_cpp::detail::is_transport<int>::value);
+
+} // namespace
+
+extern "C" void test_slip_hpp(void)
+{
+    TestLink link(7);
+    std::uint8_t frame1[] = { 0x1, SLIP_END, 0x2, SLIP_ESC, 0x3 };
+    std::array<std::uint8_t, 16> frame2;
+    std::vector<std::uint8_t> frame3(17, 0x5);
+    std::array<std::uint8_t, 16> received;
+    std::uint8_t small[2];
+
+    for (std::size_t i = 0; i < frame2.size(); i++)
+        frame2[i] = (i & 1) ? SLIP_END : SLIP_ESC;
+
+    CU_ASSERT_EQUAL(link.receive(received), -1);        // Nothing to read.
+    CU_ASSERT_EQUAL(link.send(frame1), 0);
+    CU_ASSERT_EQUAL(link.send(frame2), 0);
+    CU_ASSERT_EQUAL(link.send(frame3), -1);             // Longer than MaxFrame.
+    CU_ASSERT_EQUAL(link.send(slip_cpp::span<const std::uint8_t>(frame1, 1)), 0);
+    CU_ASSERT_EQUAL(link.transport().tail, 9 + 34 + 3);
+    CU_ASSERT_EQUAL(link.tx_stats().frames, 3);
+    CU_ASSERT_EQUAL(link.tx_stats().escapes, 2 + 16);
+
+    CU_ASSERT_EQUAL(link.receive(received), (long)sizeof(frame1));
+    CU_ASSERT(std::memcmp(received.data(), frame1, sizeof(frame1)) == 0);
+    CU_ASSERT_EQUAL(link.receive(received), (long)frame2.size());
+    CU_ASSERT(received == frame2);
+    CU_ASSERT_EQUAL(link.receive(small), 1);
+    CU_ASSERT_EQUAL(small[0], 0x1);
+    CU_ASSERT_EQUAL(link.receive(received), -1);
+    CU_ASSERT_EQUAL(link.rx_stats().frames, 3);
+
+    // Frame longer than the caller's buffer is dropped, the next one still arrives.
+    CU_ASSERT_EQUAL(link.send(frame1), 0);
+    CU_ASSERT_EQUAL(link.send(slip_cpp::span<const std::uint8_t>(frame1, 2)), 0);
+    CU_ASSERT_EQUAL(link.receive(small), -2);
+    CU_ASSERT_EQUAL(link.receive(small), 2);
+    CU_ASSERT(std::memcmp(small, frame1, 2) == 0);
+}
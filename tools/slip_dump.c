@@ -0,0 +1,323 @@
+/*
+ * slip_dump: index (and optionally extract) the frames of a raw SLIP capture.
+ *
+ * The capture is mmap()ed and cut at SLIP_END bytes with memchr(). Each run of other
+ * bytes is fed with its closing SLIP_END to slip_decoder_feed(), so frames, dropped
+ * frames and decoded bytes are the decoder's own. Runs the decoder discards (before the
+ * first SLIP_END, or behind a frame without a new SLIP_END) are indexed with
+ * SLIP_DUMP_FRAMING. Empty frames are skipped.
+ *
+ * Index file, all fields little-endian:
+ *   header  "SLIX", u32 version (1), u32 record size (24), u32 reserved
+ *   record  u64 offset          first encoded byte in the capture
+ *           u32 encoded length  SLIP_END delimiters excluded
+ *           u32 decoded length  FCS excluded with -f, bytes kept before a drop, 0 with
+ *                               SLIP_DUMP_FRAMING
+ *           u32 flags           SLIP_DUMP_*
+ *           u32 reserved
+ *
+ * In the pcap file the timestamp of a frame is its capture offset in microseconds.
+ */
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "slip.h"
+#include "slip_crc.h"
+
+#define SLIP_DUMP_FRAMING       0x01    /* Not a frame, discarded by the decoder. */
+#define SLIP_DUMP_BAD_ESCAPE    0x02    /* SLIP_ESC not followed by SLIP_ESC_END/SLIP_ESC_ESC, dropped by the decoder. */
+#define SLIP_DUMP_TRUNCATED     0x04    /* No SLIP_END before the end of the capture. */
+#define SLIP_DUMP_OVERSIZE      0x08    /* Decoded length above -m. */
+#define SLIP_DUMP_FCS           0x10    /* CRC-32C FCS mismatch or frame too short, with -f. */
+
+#define SLIP_DUMP_INDEX_VERSION 1
+#define SLIP_DUMP_RECORD_SIZE   24
+#define SLIP_DUMP_SNAPLEN       262144
+#define SLIP_DUMP_LINKTYPE      147     /* LINKTYPE_USER0, 101 (LINKTYPE_RAW) for IP. */
+#define SLIP_DUMP_IO_BUFFER     (1024 * 1024)
+
+struct slip_dump_record {
+    uint64_t offset;
+    uint32_t encoded;
+    uint32_t decoded;
+    uint32_t flags;
+};
+
+struct slip_dump_stats {
+    uint64_t frames;
+    uint64_t framing;
+    uint64_t bad_escapes;
+    uint64_t truncated;
+    uint64_t oversize;
+    uint64_t fcs_errors;
+};
+
+struct slip_dump {
+    const uint8_t *map;
+    size_t size;
+    FILE *index;
+    FILE *pcap;
+    FILE *text;
+    int all;                    /* Write flagged records to the pcap file too. */
+    int fcs;
+    size_t max_frame;
+    struct slip_decoder decoder;
+    uint8_t *frame;             /* Decoder buffer, as long as the longest run. */
+    size_t frame_size;
+    struct slip_dump_stats stats;
+};
+
+static void put_le32(uint8_t *p, uint32_t v)
+{
+    for (int i = 0; i < 4; i++)
+        p[i] = (uint8_t)(v >> (8 * i));
+}
+
+static void put_le64(uint8_t *p, uint64_t v)
+{
+    put_le32(p, (uint32_t)v);
+    put_le32(p + 4, (uint32_t)(v >> 32));
+}
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static int slip_dump_pcap_header(FILE *pcap, uint32_t linktype)
+{
+    const struct {
+        uint32_t magic;
+        uint16_t major, minor;
+        int32_t thiszone;
+        uint32_t sigfigs, snaplen, linktype;
+    } header = { 0xa1b2c3d4, 2, 4, 0, 0, SLIP_DUMP_SNAPLEN, linktype };
+
+    return fwrite(&header, sizeof(header), 1, pcap) == 1 ? 0 : -1;
+}
+
+static int slip_dump_pcap_record(struct slip_dump *dump, const struct slip_dump_record *record)
+{
+    uint32_t caplen = record->decoded < SLIP_DUMP_SNAPLEN ? record->decoded : SLIP_DUMP_SNAPLEN;
+    const struct {
+        uint32_t sec, usec, caplen, len;
+    } header = { (uint32_t)(record->offset / 1000000), (uint32_t)(record->offset % 1000000), caplen, record->decoded };
+
+    if (fwrite(&header, sizeof(header), 1, dump->pcap) != 1)
+        return -1;
+    return fwrite(dump->frame, 1, caplen, dump->pcap) == caplen ? 0 : -1;
+}
+
+static int slip_dump_record(struct slip_dump *dump, struct slip_dump_record *record)
+{
+    int frame = !(record->flags & SLIP_DUMP_FRAMING);
+
+    if (dump->max_frame && record->decoded > dump->max_frame)
+        record->flags |= SLIP_DUMP_OVERSIZE;
+    int want_pcap = dump->pcap && (dump->all || record->flags == 0);
+
+    dump->stats.frames      += frame;
+    dump->stats.framing     += !frame;
+    dump->stats.bad_escapes += !!(record->flags & SLIP_DUMP_BAD_ESCAPE);
+    dump->stats.truncated   += !!(record->flags & SLIP_DUMP_TRUNCATED);
+    dump->stats.oversize    += !!(record->flags & SLIP_DUMP_OVERSIZE);
+    dump->stats.fcs_errors  += !!(record->flags & SLIP_DUMP_FCS);
+
+    if (dump->index) {
+        uint8_t buf[SLIP_DUMP_RECORD_SIZE] = { 0 };
+        put_le64(&buf[0], record->offset);
+        put_le32(&buf[8], record->encoded);
+        put_le32(&buf[12], record->decoded);
+        put_le32(&buf[16], record->flags);
+        if (fwrite(buf, sizeof(buf), 1, dump->index) != 1)
+            return -1;
+    }
+    if (dump->text)
+        fprintf(dump->text, "%12llu %8u %8u 0x%02x\n", (unsigned long long)record->offset,
+                record->encoded, record->decoded, record->flags);
+    if (want_pcap && slip_dump_pcap_record(dump, record) != 0)
+        return -1;
+    return 0;
+}
+
+/* Feed the decoder a run at a time, a SLIP_END run or a run of other bytes with its closing SLIP_END. */
+static int slip_dump_run(struct slip_dump *dump)
+{
+    struct slip_decoder *decoder = &dump->decoder;
+    const uint8_t *map = dump->map;
+    size_t pos = 0, used;
+
+    slip_decoder_init(decoder, NULL, 0);
+    decoder->fcs = dump->fcs;
+    while (pos < dump->size) {
+        if (map[pos] == SLIP_END) {
+            // Only the state changes, the empty frames of the run are skipped.
+            size_t end = pos;
+            while (end < dump->size && map[end] == SLIP_END)
+                end++;
+            for (; pos < end; pos += used)
+                slip_decoder_feed(decoder, &map[pos], end - pos, &used);
+            continue;
+        }
+
+        const uint8_t *sep = memchr(&map[pos], SLIP_END, dump->size - pos);
+        size_t end = sep ? (size_t)(sep - map) : dump->size;
+        struct slip_dump_record record = { .offset = pos, .encoded = (uint32_t)(end - pos) };
+
+        // Decoded bytes are never more than the encoded ones, the buffer is never too small.
+        if (dump->frame_size < end - pos) {
+            uint8_t *frame = realloc(dump->frame, end - pos);
+            if (frame == NULL)
+                return -1;
+            dump->frame = frame;
+            dump->frame_size = end - pos;
+        }
+        decoder->buffer = dump->frame;
+        decoder->size   = dump->frame_size;
+
+        struct slip_rx_stats stats = decoder->stats;
+        int framing = decoder->state != SLIP_FRAME_START_STATE && decoder->state != SLIP_DECODING_STATE;
+        size_t limit = sep ? end + 1 : end;
+        for (; pos < limit; pos += used)
+            slip_decoder_feed(decoder, &map[pos], limit - pos, &used);
+
+        if (framing)
+            record.flags |= SLIP_DUMP_FRAMING;
+        if (decoder->stats.bad_escapes != stats.bad_escapes)
+            record.flags |= SLIP_DUMP_BAD_ESCAPE;
+        if (decoder->stats.fcs_errors != stats.fcs_errors)
+            record.flags |= SLIP_DUMP_FCS;
+        if (sep == NULL)
+            record.flags |= SLIP_DUMP_TRUNCATED;
+        record.decoded = framing ? 0 : (uint32_t)decoder->length;
+        if (slip_dump_record(dump, &record) != 0)
+            return -1;
+    }
+    return 0;
+}
+
+static FILE *slip_dump_open(const char *path)
+{
+    FILE *file = strcmp(path, "-") == 0 ? stdout : fopen(path, "wb");
+    if (file)
+        setvbuf(file, NULL, _IOFBF, SLIP_DUMP_IO_BUFFER);
+    return file;
+}
+
+static void usage(const char *name)
+{
+    fprintf(stderr,
+            "usage: %s [-i index] [-w pcap] [-a] [-f] [-m max] [-l linktype] [-t] capture\n"
+            "  -i index     write the binary frame index (- for stdout)\n"
+            "  -w pcap      write decoded frames to a pcap file (- for stdout)\n"
+            "  -a           write flagged records to the pcap file too\n"
+            "  -f           check and strip the CRC-32C FCS of frames\n"
+            "  -m max       flag frames decoded longer than max bytes\n"
+            "  -l linktype  pcap link type, default %d (USER0), 101 for raw IP\n"
+            "  -t           print the index as text to stdout\n",
+            name, SLIP_DUMP_LINKTYPE);
+}
+
+int main(int argc, char *argv[])
+{
+    struct slip_dump dump = { .map = NULL };
+    const char *index_path = NULL, *pcap_path = NULL;
+    uint32_t linktype = SLIP_DUMP_LINKTYPE;
+    int opt, ret = 1;
+
+    while ((opt = getopt(argc, argv, "i:w:afm:l:t")) != -1) {
+        switch (opt) {
+        case 'i':   index_path = optarg;                            break;
+        case 'w':   pcap_path = optarg;                             break;
+        case 'a':   dump.all = 1;                                   break;
+        case 'f':   dump.fcs = 1;                                   break;
+        case 'm':   dump.max_frame = strtoul(optarg, NULL, 0);      break;
+        case 'l':   linktype = (uint32_t)strtoul(optarg, NULL, 0);  break;
+        case 't':   dump.text = stdout;                             break;
+        default:
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (optind + 1 != argc) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    const char *path = argv[optind];
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) < 0) {
+        fprintf(stderr, "%s: %s\n", path, strerror(errno));
+        return 1;
+    }
+    dump.size = (size_t)st.st_size;
+    if (dump.size > 0) {
+        void *map = mmap(NULL, dump.size, PROT_READ, MAP_PRIVATE | MAP_POPULATE, fd, 0);
+        if (map == MAP_FAILED) {
+            fprintf(stderr, "%s: mmap: %s\n", path, strerror(errno));
+            close(fd);
+            return 1;
+        }
+        madvise(map, dump.size, MADV_SEQUENTIAL);
+        dump.map = map;
+    }
+    close(fd);
+
+    if (index_path && (dump.index = slip_dump_open(index_path)) == NULL) {
+        fprintf(stderr, "%s: %s\n", index_path, strerror(errno));
+        goto out;
+    }
+    if (pcap_path && ((dump.pcap = slip_dump_open(pcap_path)) == NULL || slip_dump_pcap_header(dump.pcap, linktype) != 0)) {
+        fprintf(stderr, "%s: %s\n", pcap_path, strerror(errno));
+        goto out;
+    }
+    if (dump.index) {
+        uint8_t header[16] = { 'S', 'L', 'I', 'X' };
+        put_le32(&header[4], SLIP_DUMP_INDEX_VERSION);
+        put_le32(&header[8], SLIP_DUMP_RECORD_SIZE);
+        if (fwrite(header, sizeof(header), 1, dump.index) != 1) {
+            fprintf(stderr, "%s: %s\n", index_path, strerror(errno));
+            goto out;
+        }
+    }
+
+    double start = now();
+    if (slip_dump_run(&dump) != 0) {
+        fprintf(stderr, "%s: %s\n", path, strerror(errno));
+        goto out;
+    }
+    if ((dump.index && fflush(dump.index) != 0) || (dump.pcap && fflush(dump.pcap) != 0)) {
+        fprintf(stderr, "write: %s\n", strerror(errno));
+        goto out;
+    }
+    double elapsed = now() - start;
+
+    fprintf(stderr, "%s: %zu bytes, %llu frames, %llu framing, %llu bad escape, %llu truncated, "
+            "%llu oversize, %llu fcs, %.1f MB/s\n", path, dump.size,
+            (unsigned long long)dump.stats.frames, (unsigned long long)dump.stats.framing,
+            (unsigned long long)dump.stats.bad_escapes, (unsigned long long)dump.stats.truncated,
+            (unsigned long long)dump.stats.oversize, (unsigned long long)dump.stats.fcs_errors,
+            elapsed > 0 ? dump.size / elapsed / 1e6 : 0.0);
+    ret = 0;
+
+out:
+    if (dump.index && dump.index != stdout)
+        fclose(dump.index);
+    if (dump.pcap && dump.pcap != stdout)
+        fclose(dump.pcap);
+    if (dump.map)
+        munmap((void *)dump.map, dump.size);
+    free(dump.frame);
+    return ret;
+}